@@ -1,6 +1,7 @@
 QT       += core gui
 QT       += network
 QT       += multimedia multimediawidgets
+QT       += concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -18,11 +19,41 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    cacherevalidator.cpp \
+    dictionarybackend.cpp \
+    entryformatter.cpp \
+    entryrenderer.cpp \
+    hedgedlookup.cpp \
+    historyexporter.cpp \
+    historystore.cpp \
+    lemmatizer.cpp \
+    loaddriver.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    mockdictionaryserver.cpp \
+    negativecache.cpp \
+    responsecache.cpp \
+    sharedjournal.cpp \
+    synonymgraph.cpp \
+    textkernels.cpp
 
 HEADERS += \
-    mainwindow.h
+    cacherevalidator.h \
+    dictionarybackend.h \
+    entryformatter.h \
+    entryrenderer.h \
+    hedgedlookup.h \
+    historyexporter.h \
+    historystore.h \
+    lemmatizer.h \
+    loaddriver.h \
+    mainwindow.h \
+    mockdictionaryserver.h \
+    negativecache.h \
+    responsecache.h \
+    sharedjournal.h \
+    synonymgraph.h \
+    textkernels.h
 
 FORMS += \
     mainwindow.ui
@@ -40,6 +71,9 @@ RESOURCES += \
 
 DESTDIR = ./
 
+# Process memory figures for the load test report
+win32: LIBS += -lpsapi
+
 CONFIG -= debug_and_release
 
 
@@ -0,0 +1,138 @@
+#include "cacherevalidator.h"
+#include "responsecache.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimer>
+#include <QUrl>
+
+namespace {
+const int kSweepIntervalMs = 10 * 60 * 1000;
+const int kRequestTimeoutMs = 30 * 1000;
+}
+
+CacheRevalidator::CacheRevalidator(ResponseCache *cache, const QString &backendName, const QString &urlTemplate,
+                                   QObject *parent)
+    : QObject(parent)
+    , cache(cache)
+    , backend(backendName)
+    , templateUrl(urlTemplate)
+    , networkManager(new QNetworkAccessManager(this))
+    , idleTimer(new QTimer(this))
+    , sweepTimer(new QTimer(this))
+    , inFlight(false)
+    , foregroundActive(false)
+    , notModified(0)
+    , refreshed(0)
+{
+    connect(idleTimer, &QTimer::timeout, this, &CacheRevalidator::processNext);
+    connect(sweepTimer, &QTimer::timeout, this, &CacheRevalidator::sweep);
+    connect(networkManager, &QNetworkAccessManager::finished, this, &CacheRevalidator::onReplyFinished);
+}
+
+void CacheRevalidator::enqueue(const QString &key)
+{
+    if (!queued.contains(key)) {
+        queued.insert(key);
+        queue.append(key);
+    }
+}
+
+void CacheRevalidator::start(int intervalMs)
+{
+    sweep();
+    idleTimer->start(intervalMs);
+    sweepTimer->start(kSweepIntervalMs);
+}
+
+QString CacheRevalidator::statsSummary() const
+{
+    return QString("Revalidated %1 unchanged, %2 refreshed").arg(notModified).arg(refreshed);
+}
+
+void CacheRevalidator::sweep()
+{
+    for (const QString &key : cache->staleKeys()) {
+        // Another backend's body cannot be checked against this URL. Entries
+        // from before backends were recorded are tried until they get a 404.
+        QString origin = cache->value(key).backend;
+        if ((origin.isEmpty() || origin == backend) && !unknownKeys.contains(key)) {
+            enqueue(key);
+        }
+    }
+}
+
+void CacheRevalidator::processNext()
+{
+    // Foreground lookups always go first
+    if (inFlight || foregroundActive || queue.isEmpty()) {
+        return;
+    }
+
+    QString key = queue.takeFirst();
+    queued.remove(key);
+
+    ResponseCache::Freshness state = cache->freshness(key);
+    if (state == ResponseCache::Missing || state == ResponseCache::Fresh) {
+        return;
+    }
+
+    CachedResponse entry = cache->value(key);
+    QString url = templateUrl.arg(QString::fromUtf8(QUrl::toPercentEncoding(entry.queryWord)));
+    QNetworkRequest request((QUrl(url)));
+    request.setPriority(QNetworkRequest::LowPriority);
+    if (!entry.etag.isEmpty()) {
+        request.setRawHeader("If-None-Match", entry.etag);
+    }
+    if (!entry.lastModified.isEmpty()) {
+        request.setRawHeader("If-Modified-Since", entry.lastModified);
+    }
+
+    QNetworkReply *reply = networkManager->get(request);
+    reply->setProperty("cacheKey", key);
+    inFlight = true;
+
+    // Qt 5 has no default transfer timeout; one hung request would stop
+    // revalidation for the rest of the session. Aborting finishes the reply.
+    QTimer::singleShot(kRequestTimeoutMs, reply, [reply]() {
+        if (reply->isRunning()) {
+            reply->abort();
+        }
+    });
+}
+
+void CacheRevalidator::onReplyFinished(QNetworkReply *reply)
+{
+    inFlight = false;
+    QString key = reply->property("cacheKey").toString();
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    if (status == 304) {
+        cache->markValidated(key, reply->rawHeader("ETag"), reply->rawHeader("Last-Modified"));
+        notModified++;
+    } else if (status == 200 && reply->error() == QNetworkReply::NoError) {
+        // A captive portal answers 200 too; only an entry list replaces the body
+        QByteArray data = reply->readAll();
+        if (QJsonDocument::fromJson(data).array().isEmpty()) {
+            reply->deleteLater();
+            return;
+        }
+
+        CachedResponse entry = cache->value(key);
+        entry.data = data;
+        entry.etag = reply->rawHeader("ETag");
+        entry.lastModified = reply->rawHeader("Last-Modified");
+        entry.fetchedAt = 0;
+        entry.validatedAt = 0;
+        cache->store(key, entry);
+        refreshed++;
+    } else if (status == 404) {
+        // Not this backend's word; the stale copy is still served until it expires
+        unknownKeys.insert(key);
+    }
+    // Anything else leaves the stale copy in place for the next sweep
+
+    reply->deleteLater();
+}
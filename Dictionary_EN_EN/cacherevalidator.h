@@ -0,0 +1,56 @@
+#ifndef CACHEREVALIDATOR_H
+#define CACHEREVALIDATOR_H
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+class ResponseCache;
+
+// Background refresh of stale cache entries that came from one backend.
+// Sends one conditional GET (If-None-Match / If-Modified-Since) at a time,
+// at low network priority and only while no foreground lookup is running.
+// A 304 just refreshes the entry's validation time; a 200 replaces the
+// stored body.
+class CacheRevalidator : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Entries stored from backendName are checked against urlTemplate
+    CacheRevalidator(ResponseCache *cache, const QString &backendName, const QString &urlTemplate,
+                     QObject *parent = nullptr);
+
+    void enqueue(const QString &key);
+    void setForegroundActive(bool active) { foregroundActive = active; }
+    void start(int intervalMs = 2000);
+
+    int notModifiedCount() const { return notModified; }
+    int refreshedCount() const { return refreshed; }
+    QString statsSummary() const;
+
+private:
+    void processNext();
+    void sweep();
+    void onReplyFinished(QNetworkReply *reply);
+
+    ResponseCache *cache;
+    QString backend;
+    QString templateUrl;
+    QNetworkAccessManager *networkManager;
+    QTimer *idleTimer;
+    QTimer *sweepTimer;
+    QStringList queue;
+    QSet<QString> queued;
+    QSet<QString> unknownKeys;    // Answered 404; not asked again this session
+    bool inFlight;
+    bool foregroundActive;
+    int notModified;
+    int refreshed;
+};
+
+#endif // CACHEREVALIDATOR_H
@@ -0,0 +1,128 @@
+#include "dictionarybackend.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QTimer>
+#include <QUrl>
+
+DictionaryBackend::DictionaryBackend(const QString &name, QObject *parent)
+    : QObject(parent)
+    , backendName(name)
+{
+    static const int resultTypeId = qRegisterMetaType<DictionaryResult>("DictionaryResult");
+    Q_UNUSED(resultTypeId);
+}
+
+HttpDictionaryBackend::HttpDictionaryBackend(const QString &name, const QString &urlTemplate, QObject *parent)
+    : DictionaryBackend(name, parent)
+    , templateUrl(urlTemplate)
+    , networkManager(new QNetworkAccessManager(this))
+{
+}
+
+void HttpDictionaryBackend::lookup(quint64 requestId, const QString &word)
+{
+    QString url = templateUrl.arg(QString::fromUtf8(QUrl::toPercentEncoding(word)));
+    QNetworkReply *reply = networkManager->get(QNetworkRequest(QUrl(url)));
+    reply->setProperty("requestId", requestId);
+    reply->setProperty("word", word);
+
+    // Time the round trip so the hedging policy can learn this backend's latency
+    QElapsedTimer timer;
+    timer.start();
+    pendingReplies.insert(requestId, reply);
+
+    connect(reply, &QNetworkReply::finished, this, [this, reply, timer]() {
+        reply->setProperty("elapsedMs", timer.elapsed());
+        onReplyFinished(reply);
+    });
+}
+
+void HttpDictionaryBackend::cancel(quint64 requestId)
+{
+    QNetworkReply *reply = pendingReplies.take(requestId);
+    if (reply) {
+        // Dropped from pendingReplies first, so the finished() it emits is ignored
+        reply->abort();
+    }
+}
+
+void HttpDictionaryBackend::onReplyFinished(QNetworkReply *reply)
+{
+    quint64 requestId = reply->property("requestId").toULongLong();
+    bool cancelled = pendingReplies.value(requestId) != reply;
+    pendingReplies.remove(requestId);
+
+    if (!cancelled) {
+        DictionaryResult result;
+        result.requestId = requestId;
+        result.word = reply->property("word").toString();
+        result.backend = name();
+        result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        result.elapsedMs = reply->property("elapsedMs").toLongLong();
+        result.ok = reply->error() == QNetworkReply::NoError;
+        if (result.ok) {
+            result.data = reply->readAll();
+            result.etag = reply->rawHeader("ETag");
+            result.lastModified = reply->rawHeader("Last-Modified");
+        } else {
+            result.errorString = reply->errorString();
+        }
+        emit finished(result);
+    }
+    reply->deleteLater();
+}
+
+LocalFileDictionaryBackend::LocalFileDictionaryBackend(const QString &name, const QString &filePath, QObject *parent)
+    : DictionaryBackend(name, parent)
+{
+    load(filePath);
+}
+
+void LocalFileDictionaryBackend::load(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+
+    // Keep each entry array pre-serialized so a hit is just a hash lookup
+    QJsonObject root = doc.object();
+    for (auto it = root.constBegin(); it != root.constEnd(); ++it) {
+        QJsonArray entryArray = it.value().toArray();
+        if (!entryArray.isEmpty()) {
+            entries.insert(it.key().toLower(), QJsonDocument(entryArray).toJson(QJsonDocument::Compact));
+        }
+    }
+}
+
+void LocalFileDictionaryBackend::lookup(quint64 requestId, const QString &word)
+{
+    DictionaryResult result;
+    result.requestId = requestId;
+    result.word = word;
+    result.backend = name();
+
+    auto it = entries.constFind(word.toLower());
+    if (it != entries.constEnd()) {
+        result.ok = true;
+        result.httpStatus = 200;
+        result.data = it.value();
+    } else {
+        result.httpStatus = 404;
+        result.errorString = "Word not in local dictionary";
+    }
+
+    // Answer from the event loop so callers see the same ordering as network backends
+    QTimer::singleShot(0, this, [this, result]() {
+        emit finished(result);
+    });
+}
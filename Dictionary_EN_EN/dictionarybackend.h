@@ -0,0 +1,97 @@
+#ifndef DICTIONARYBACKEND_H
+#define DICTIONARYBACKEND_H
+
+#include <QObject>
+#include <QHash>
+#include <QByteArray>
+#include <QString>
+#include <QMetaType>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Result of one lookup, as produced by any backend
+struct DictionaryResult
+{
+    quint64 requestId = 0;
+    QString word;
+    QString backend;
+    QByteArray data;        // Body in dictionaryapi.dev JSON format
+    int httpStatus = 0;
+    bool ok = false;
+    QString errorString;
+    qint64 elapsedMs = 0;
+    QByteArray etag;        // HTTP validators, kept for conditional revalidation
+    QByteArray lastModified;
+};
+
+Q_DECLARE_METATYPE(DictionaryResult)
+
+// A source of dictionary entries. Implementations answer asynchronously
+// through the finished() signal, never from inside lookup().
+class DictionaryBackend : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DictionaryBackend(const QString &name, QObject *parent = nullptr);
+
+    QString name() const { return backendName; }
+
+    virtual void lookup(quint64 requestId, const QString &word) = 0;
+    virtual void cancel(quint64 requestId) { Q_UNUSED(requestId); }
+
+    // False for partial sources, whose "not found" says nothing about the word
+    virtual bool isAuthoritative() const { return true; }
+
+signals:
+    void finished(const DictionaryResult &result);
+
+private:
+    QString backendName;
+};
+
+// HTTP source; urlTemplate contains %1 where the word goes,
+// e.g. https://api.dictionaryapi.dev/api/v2/entries/en/%1
+class HttpDictionaryBackend : public DictionaryBackend
+{
+    Q_OBJECT
+
+public:
+    HttpDictionaryBackend(const QString &name, const QString &urlTemplate, QObject *parent = nullptr);
+
+    QString urlTemplate() const { return templateUrl; }
+
+    void lookup(quint64 requestId, const QString &word) override;
+    void cancel(quint64 requestId) override;
+
+private:
+    void onReplyFinished(QNetworkReply *reply);
+
+    QString templateUrl;
+    QNetworkAccessManager *networkManager;
+    QHash<quint64, QNetworkReply *> pendingReplies;
+};
+
+// Offline source backed by a JSON file mapping each word to an
+// API-format entry array: { "word": [ { "word": ..., "meanings": ... } ] }
+class LocalFileDictionaryBackend : public DictionaryBackend
+{
+    Q_OBJECT
+
+public:
+    LocalFileDictionaryBackend(const QString &name, const QString &filePath, QObject *parent = nullptr);
+
+    bool isLoaded() const { return !entries.isEmpty(); }
+    const QHash<QString, QByteArray> &entryData() const { return entries; }
+
+    void lookup(quint64 requestId, const QString &word) override;
+    bool isAuthoritative() const override { return false; }
+
+private:
+    void load(const QString &filePath);
+
+    QHash<QString, QByteArray> entries;
+};
+
+#endif // DICTIONARYBACKEND_H
@@ -0,0 +1,236 @@
+#include "entryformatter.h"
+#include "textkernels.h"
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QStringList>
+#include <QUrl>
+
+QString EntryFormatter::phoneticText(const QJsonObject &entry)
+{
+    // Try to get phonetic text
+    if (entry.contains("phonetic")) {
+        QString phonetic = entry["phonetic"].toString();
+        if (!phonetic.isEmpty()) {
+            return phonetic;
+        }
+    }
+
+    // If no main phonetic, try to get from phonetics array
+    if (entry.contains("phonetics")) {
+        QJsonArray phonetics = entry["phonetics"].toArray();
+        for (const QJsonValue &phoneticValue : phonetics) {
+            QJsonObject phonetic = phoneticValue.toObject();
+            if (phonetic.contains("text")) {
+                QString text = phonetic["text"].toString();
+                if (!text.isEmpty()) {
+                    return text;
+                }
+            }
+        }
+    }
+
+    return "";
+}
+
+QString EntryFormatter::audioUrl(const QJsonObject &entry)
+{
+    if (entry.contains("phonetics")) {
+        QJsonArray phonetics = entry["phonetics"].toArray();
+        for (const QJsonValue &phoneticValue : phonetics) {
+            QJsonObject phonetic = phoneticValue.toObject();
+            if (phonetic.contains("audio") && !phonetic["audio"].toString().isEmpty()) {
+                QString audioUrl = phonetic["audio"].toString();
+                if (audioUrl.startsWith("http")) {
+                    return audioUrl;
+                }
+            }
+        }
+    }
+    return "";
+}
+
+QString EntryFormatter::html(const QJsonObject &entry)
+{
+    // API strings are escaped; they may contain '<' or '&'
+    QString word = TextKernels::escapeHtml(entry["word"].toString());
+    QString phoneticText = EntryFormatter::phoneticText(entry);
+
+    // Format for display (HTML)
+    QString result;
+    result += QString("<h2 style='color: red;'>%1</h2>").arg(word);
+
+    // Add pronunciation
+//    if (!phoneticText.isEmpty()) {
+//        result += QString("<p style='color: #666; font-size: 14px; margin-bottom: 10px;'>");
+//        result += QString("<b>Pronunciation:</b> %1").arg(phoneticText);
+//        result += " 🔊";
+//        result += "</p>";
+//    }
+
+    QJsonArray meanings = entry["meanings"].toArray();
+
+    for (const QJsonValue &meaningValue : meanings) {
+        QJsonObject meaning = meaningValue.toObject();
+        QString partOfSpeech = meaning["partOfSpeech"].toString();
+
+        QString posColor = "#2E86AB"; // Different color for each part of speech
+        if (partOfSpeech == "noun") posColor = "#A23B72";
+        else if (partOfSpeech == "verb") posColor = "#F18F01";
+        else if (partOfSpeech == "adjective") posColor = "#C73E1D";
+        else if (partOfSpeech == "adverb") posColor = "#3E8914";
+        else if (partOfSpeech == "preposition") posColor = "#8B1E3F";
+
+        result += QString("<h3 style='color: %1; background-color: #f0f0f0; padding: 5px;'>[%2]</h3>")
+                     .arg(posColor, TextKernels::escapeHtml(partOfSpeech.toUpper()));
+
+        QJsonArray definitions = meaning["definitions"].toArray();
+        for (int i = 0; i < definitions.size() && i < 5; ++i) {
+            QJsonObject definition = definitions[i].toObject();
+            QString def = TextKernels::escapeHtml(definition["definition"].toString());
+            result += QString("<p><b>%1.</b> %2").arg(i + 1).arg(def);
+
+            if (definition.contains("example")) {
+                QString example = TextKernels::escapeHtml(definition["example"].toString());
+                result += QString("<br><i>Example: %1</i>").arg(example);
+            }
+
+            // Add synonyms if available
+            if (definition.contains("synonyms")) {
+                QJsonArray synonyms = definition["synonyms"].toArray();
+                if (!synonyms.isEmpty()) {
+                    QStringList synonymList;
+                    for (const QJsonValue &synonym : synonyms) {
+                        synonymList.append(synonym.toString());
+                    }
+                    result += QString("<br><span style='color: #666;'><b>Synonyms:</b> %1</span>")
+                                 .arg(wordLinks(synonymList));
+                }
+            }
+
+            result += "</p>";
+        }
+    }
+
+    return result;
+}
+
+QString EntryFormatter::markdown(const QJsonObject &entry)
+{
+    QString markdown;
+    QString word = entry["word"].toString();
+    QString phoneticText = EntryFormatter::phoneticText(entry);
+
+    // Word in red (using HTML color for markdown compatibility)
+    markdown += QString("# <font color='red'>%1</font>\n\n").arg(TextKernels::escapeHtml(word));
+
+    // Add pronunciation
+//    if (!phoneticText.isEmpty()) {
+//        markdown += QString("**Pronunciation:** %1").arg(phoneticText);
+//        markdown += " 🔊";
+//        markdown += "\n\n";
+//    }
+
+    QJsonArray meanings = entry["meanings"].toArray();
+
+    for (const QJsonValue &meaningValue : meanings) {
+        QJsonObject meaning = meaningValue.toObject();
+        QString partOfSpeech = meaning["partOfSpeech"].toString();
+
+        // Part of speech in brackets
+        markdown += QString("**[%1]**\n\n").arg(partOfSpeech.toUpper());
+
+        QJsonArray definitions = meaning["definitions"].toArray();
+        for (int i = 0; i < definitions.size() && i < 5; ++i) {
+            QJsonObject definition = definitions[i].toObject();
+            QString def = definition["definition"].toString();
+
+            // Numbered definitions on new lines
+            markdown += QString("%1. %2").arg(i + 1).arg(def);
+
+            if (definition.contains("example")) {
+                QString example = definition["example"].toString();
+                markdown += QString("\n   *Example: %1*").arg(example);
+            }
+
+            // Add synonyms if available
+            if (definition.contains("synonyms")) {
+                QJsonArray synonyms = definition["synonyms"].toArray();
+                if (!synonyms.isEmpty()) {
+                    QStringList synonymList;
+                    for (const QJsonValue &synonym : synonyms) {
+                        synonymList.append(synonym.toString());
+                    }
+                    markdown += QString("\n   *Synonyms: %1*").arg(synonymList.join(", "));
+                }
+            }
+
+            markdown += "\n\n";
+        }
+    }
+
+    return markdown;
+}
+
+QString EntryFormatter::wordLinks(const QStringList &words)
+{
+    QStringList links;
+    for (const QString &word : words) {
+        links.append(QString("<a href='word:%1'>%2</a>")
+                     .arg(QString::fromUtf8(QUrl::toPercentEncoding(word)), TextKernels::escapeHtml(word)));
+    }
+    return links.join(", ");
+}
+
+QString EntryFormatter::htmlToMarkdown(const QString &html)
+{
+    // Mirrors the layout of markdown() for the tags html() emits
+    QString markdown = html;
+
+    // Drop the <h2> headword; callers add their own heading
+    int heading = markdown.indexOf("<h2");
+    while (heading >= 0) {
+        int end = markdown.indexOf("</h2>", heading);
+        if (end < 0) {
+            break;
+        }
+        markdown.remove(heading, end + 5 - heading);
+        heading = markdown.indexOf("<h2", heading);
+    }
+
+    // <h3 style=...>[NOUN]</h3> becomes **[NOUN]**
+    int partOfSpeech = markdown.indexOf("<h3");
+    while (partOfSpeech >= 0) {
+        int open = markdown.indexOf('>', partOfSpeech);
+        if (open < 0) {
+            break;
+        }
+        markdown.replace(partOfSpeech, open + 1 - partOfSpeech, "**");
+        partOfSpeech = markdown.indexOf("<h3", partOfSpeech);
+    }
+    markdown.replace("</h3>", "**\n\n");
+
+    markdown.replace("<b>", "**");
+    markdown.replace("</b>", "**");
+    markdown.replace("<i>", "*");
+    markdown.replace("</i>", "*");
+    markdown.replace("<br>", "\n   ");
+    markdown.replace("</p>", "\n\n");
+
+    return TextKernels::decodeEntities(TextKernels::stripTags(markdown)).trimmed() + "\n";
+}
+
+QString EntryFormatter::htmlToPlainText(const QString &html)
+{
+    QString text = html;
+    text.replace("</h2>", "\n");
+    text.replace("</h3>", "\n");
+    text.replace("</p>", "\n");
+    text.replace("<br>", "\n");
+
+    return TextKernels::decodeEntities(TextKernels::stripTags(text)).trimmed();
+}
+
+QString EntryFormatter::historyMarkdown(const QString &word, const QString &html)
+{
+    return QString("## <font color='red'>%1</font>\n\n").arg(TextKernels::escapeHtml(word)) + htmlToMarkdown(html);
+}
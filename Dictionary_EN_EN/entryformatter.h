@@ -0,0 +1,29 @@
+#ifndef ENTRYFORMATTER_H
+#define ENTRYFORMATTER_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+// Rendering of dictionary entries. Everything here is free of widget state,
+// so it can be called from worker threads as well as from the GUI.
+namespace EntryFormatter
+{
+    QString phoneticText(const QJsonObject &entry);
+    // First http(s) pronunciation recording, or an empty string
+    QString audioUrl(const QJsonObject &entry);
+
+    // Entry from the dictionaryapi.dev JSON format
+    QString html(const QJsonObject &entry);
+    QString markdown(const QJsonObject &entry);
+
+    // Comma-separated word:<word> links, handled by the result view
+    QString wordLinks(const QStringList &words);
+
+    // Conversions of the HTML produced by html(), as stored in the history file
+    QString htmlToMarkdown(const QString &html);
+    QString htmlToPlainText(const QString &html);
+    QString historyMarkdown(const QString &word, const QString &html);
+}
+
+#endif // ENTRYFORMATTER_H
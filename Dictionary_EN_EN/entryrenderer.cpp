@@ -0,0 +1,94 @@
+#include "entryrenderer.h"
+#include "entryformatter.h"
+#include "synonymgraph.h"
+#include "textkernels.h"
+#include <QFutureWatcher>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QtConcurrent>
+
+EntryRenderer::EntryRenderer(QObject *parent)
+    : QObject(parent)
+    , nextTicket(1)
+    , nextToDeliver(1)
+    , discardBefore(0)
+{
+    qRegisterMetaType<RenderedEntry>("RenderedEntry");
+
+    // Separate from the global pool, so a running export cannot starve lookups
+    pool.setMaxThreadCount(qMax(2, QThread::idealThreadCount()));
+}
+
+EntryRenderer::~EntryRenderer()
+{
+    pool.waitForDone();
+}
+
+quint64 EntryRenderer::render(const QString &queryWord, const QByteArray &data, bool fromCache)
+{
+    quint64 ticket = nextTicket++;
+
+    // The watcher reports back through a queued connection to this thread
+    QFutureWatcher<RenderedEntry> *watcher = new QFutureWatcher<RenderedEntry>(this);
+    connect(watcher, &QFutureWatcher<RenderedEntry>::finished, this, [this, watcher, ticket, fromCache]() {
+        RenderedEntry entry = watcher->result();
+        entry.ticket = ticket;
+        entry.fromCache = fromCache;
+        watcher->deleteLater();
+
+        if (ticket < discardBefore) {
+            return;
+        }
+        completed.insert(ticket, entry);
+        deliverCompleted();
+    });
+    watcher->setFuture(QtConcurrent::run(&pool, [queryWord, data]() {
+        return EntryRenderer::renderEntry(queryWord, data);
+    }));
+
+    return ticket;
+}
+
+void EntryRenderer::discardPending()
+{
+    discardBefore = nextTicket;
+    nextToDeliver = nextTicket;
+    completed.clear();
+}
+
+void EntryRenderer::deliverCompleted()
+{
+    while (!completed.isEmpty() && completed.firstKey() == nextToDeliver) {
+        RenderedEntry entry = completed.take(nextToDeliver);
+        nextToDeliver++;
+        emit rendered(entry);
+    }
+}
+
+RenderedEntry EntryRenderer::renderEntry(const QString &queryWord, const QByteArray &data)
+{
+    RenderedEntry entry;
+    entry.queryWord = queryWord;
+
+    // An error page or a captive portal's HTML is not an empty answer
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(data, &parseError);
+    entry.valid = parseError.error == QJsonParseError::NoError && document.isArray();
+
+    QJsonArray entries = document.array();
+    if (entries.isEmpty()) {
+        return entry;
+    }
+
+    QJsonObject firstEntry = entries.first().toObject();
+    entry.found = true;
+    entry.headword = firstEntry["word"].toString();
+    entry.html = EntryFormatter::html(firstEntry);
+    entry.markdown = EntryFormatter::markdown(firstEntry);
+    entry.shortDefinition = TextKernels::decodeEntities(TextKernels::stripTags(entry.html)).left(100);
+    entry.audioUrl = EntryFormatter::audioUrl(firstEntry);
+    entry.synonyms = SynonymGraph::synonymLists(entries);
+    return entry;
+}
@@ -0,0 +1,66 @@
+#ifndef ENTRYRENDERER_H
+#define ENTRYRENDERER_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QMetaType>
+#include <QObject>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+// A dictionary reply parsed and formatted, ready for the widgets
+struct RenderedEntry
+{
+    quint64 ticket = 0;
+    QString queryWord;          // Word the user looked up
+    bool fromCache = false;
+    bool valid = false;         // The reply parsed as a JSON array
+    bool found = false;         // False if the reply held no entries
+
+    QString headword;
+    QString html;
+    QString markdown;
+    QString shortDefinition;    // Plain-text summary for the history list
+    QString audioUrl;
+    QVector<QPair<QString, QStringList> > synonyms;
+};
+
+Q_DECLARE_METATYPE(RenderedEntry)
+
+// Parses replies and renders HTML/Markdown on a private thread pool, so
+// large replies never block the GUI thread. Results come back on the
+// renderer's thread in the order render() was called; a slow job holds
+// back later ones rather than letting them overtake it.
+class EntryRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EntryRenderer(QObject *parent = nullptr);
+    ~EntryRenderer();
+
+    quint64 render(const QString &queryWord, const QByteArray &data, bool fromCache);
+    // Results of every render started so far are dropped instead of emitted,
+    // and later results no longer wait for them
+    void discardPending();
+
+    // The work done per job; safe on any thread
+    static RenderedEntry renderEntry(const QString &queryWord, const QByteArray &data);
+
+signals:
+    void rendered(const RenderedEntry &entry);
+
+private:
+    void deliverCompleted();
+
+    QThreadPool pool;
+    QMap<quint64, RenderedEntry> completed;
+    quint64 nextTicket;
+    quint64 nextToDeliver;
+    quint64 discardBefore;
+};
+
+#endif // ENTRYRENDERER_H
@@ -0,0 +1,221 @@
+#include "hedgedlookup.h"
+#include <QTimer>
+#include <algorithm>
+
+namespace {
+const int kLatencyWindowSize = 64;
+const int kMinSamplesForP95 = 8;
+const int kDefaultHedgeDelayMs = 800;
+}
+
+HedgedLookup::HedgedLookup(QObject *parent)
+    : QObject(parent)
+    , nextRequestId(1)
+    , minHedgeDelayMs(50)
+    , maxHedgeDelayMs(3000)
+    , hedgeCount(0)
+    , hedgeWinCount(0)
+{
+}
+
+void HedgedLookup::addBackend(DictionaryBackend *backend)
+{
+    backend->setParent(this);
+    backendChain.append(backend);
+    connect(backend, &DictionaryBackend::finished, this, &HedgedLookup::onBackendFinished);
+}
+
+void HedgedLookup::setHedgeDelayBounds(int minMs, int maxMs)
+{
+    minHedgeDelayMs = minMs;
+    maxHedgeDelayMs = qMax(minMs, maxMs);
+}
+
+int HedgedLookup::hedgeDelayFor(int backendIndex) const
+{
+    if (backendIndex < 0 || backendIndex >= backendChain.size()) {
+        return kDefaultHedgeDelayMs;
+    }
+
+    // Until enough samples exist there is no meaningful p95
+    QVector<qint64> samples = latencies.value(backendChain[backendIndex]->name()).samples;
+    if (samples.size() < kMinSamplesForP95) {
+        return qBound(minHedgeDelayMs, kDefaultHedgeDelayMs, maxHedgeDelayMs);
+    }
+
+    int rank = (samples.size() * 95 + 99) / 100 - 1;
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return qBound(minHedgeDelayMs, int(samples[rank]), maxHedgeDelayMs);
+}
+
+bool HedgedLookup::isAuthoritative(const QString &backend) const
+{
+    int index = indexOfBackend(backend);
+    return index >= 0 && backendChain[index]->isAuthoritative();
+}
+
+quint64 HedgedLookup::lookup(const QString &word)
+{
+    quint64 requestId = nextRequestId++;
+
+    PendingLookup lookup;
+    lookup.word = word;
+    lookup.started.start();
+    pending.insert(requestId, lookup);
+
+    fireNext(requestId);
+    return requestId;
+}
+
+void HedgedLookup::cancel(quint64 requestId)
+{
+    auto it = pending.find(requestId);
+    if (it == pending.end()) {
+        return;
+    }
+
+    if (it->hedgeTimer) {
+        it->hedgeTimer->deleteLater();
+    }
+    pending.erase(it);
+    for (DictionaryBackend *backend : backendChain) {
+        backend->cancel(requestId);
+    }
+}
+
+void HedgedLookup::fireNext(quint64 requestId)
+{
+    auto it = pending.find(requestId);
+    if (it == pending.end()) {
+        return;
+    }
+
+    if (it->nextBackend >= backendChain.size()) {
+        // Nothing left to try; report the most telling failure once all are done
+        if (it->outstanding == 0) {
+            DictionaryResult result = it->error;
+            if (!it->hasError) {
+                result.requestId = requestId;
+                result.word = it->word;
+                result.errorString = "No dictionary backend configured";
+            }
+            finish(requestId, result);
+        }
+        return;
+    }
+
+    int index = it->nextBackend++;
+    it->outstanding++;
+    it->firedAt.insert(index, it->started.elapsed());
+
+    // Arm the hedge for the following backend, if there is one
+    if (it->nextBackend < backendChain.size()) {
+        if (!it->hedgeTimer) {
+            it->hedgeTimer = new QTimer(this);
+            it->hedgeTimer->setSingleShot(true);
+            connect(it->hedgeTimer, &QTimer::timeout, this, [this, requestId]() {
+                auto hedged = pending.find(requestId);
+                if (hedged == pending.end()) {
+                    return;
+                }
+                if (hedged->firstHedgedBackend < 0) {
+                    hedged->firstHedgedBackend = hedged->nextBackend;
+                }
+                hedgeCount++;
+                fireNext(requestId);
+            });
+        }
+        it->hedgeTimer->start(hedgeDelayFor(index));
+    } else if (it->hedgeTimer) {
+        it->hedgeTimer->stop();
+    }
+
+    backendChain[index]->lookup(requestId, it->word);
+}
+
+void HedgedLookup::onBackendFinished(const DictionaryResult &result)
+{
+    recordLatency(result.backend, result.elapsedMs);
+
+    auto it = pending.find(result.requestId);
+    if (it == pending.end()) {
+        return;
+    }
+    it->outstanding--;
+    it->firedAt.remove(indexOfBackend(result.backend));
+
+    if (result.ok) {
+        if (it->firstHedgedBackend >= 0 && indexOfBackend(result.backend) >= it->firstHedgedBackend) {
+            hedgeWinCount++;
+        }
+        finish(result.requestId, result);
+        return;
+    }
+
+    // Keep the most telling failure to report if nobody succeeds, so a
+    // definite 404 is not replaced by a later timeout on another backend
+    if (!it->hasError || errorRank(result) > errorRank(it->error)) {
+        it->error = result;
+        it->hasError = true;
+    }
+
+    // A failure does not need to wait for the hedge timer
+    fireNext(result.requestId);
+}
+
+int HedgedLookup::errorRank(const DictionaryResult &result) const
+{
+    if (!isAuthoritative(result.backend)) {
+        return 0;
+    }
+    // Transport and server errors say nothing about the word itself
+    return result.httpStatus == 404 ? 2 : 1;
+}
+
+int HedgedLookup::indexOfBackend(const QString &name) const
+{
+    for (int i = 0; i < backendChain.size(); ++i) {
+        if (backendChain[i]->name() == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void HedgedLookup::recordLatency(const QString &backend, qint64 elapsedMs)
+{
+    if (elapsedMs <= 0) {
+        return;
+    }
+
+    LatencyWindow &window = latencies[backend];
+    if (window.samples.size() < kLatencyWindowSize) {
+        window.samples.append(elapsedMs);
+    } else {
+        window.samples[window.next] = elapsedMs;
+        window.next = (window.next + 1) % kLatencyWindowSize;
+    }
+}
+
+void HedgedLookup::finish(quint64 requestId, const DictionaryResult &result)
+{
+    PendingLookup lookup = pending.take(requestId);
+    if (lookup.hedgeTimer) {
+        lookup.hedgeTimer->deleteLater();
+    }
+
+    // Losers took at least this long; without these samples the slow tail
+    // never reaches the p95 and the hedge would fire too early
+    for (auto it = lookup.firedAt.constBegin(); it != lookup.firedAt.constEnd(); ++it) {
+        recordLatency(backendChain[it.key()]->name(), lookup.started.elapsed() - it.value());
+    }
+
+    // Losers of the race are no longer needed
+    for (DictionaryBackend *backend : backendChain) {
+        if (backend->name() != result.backend) {
+            backend->cancel(requestId);
+        }
+    }
+
+    emit finished(result);
+}
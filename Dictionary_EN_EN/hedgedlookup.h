@@ -0,0 +1,80 @@
+#ifndef HEDGEDLOOKUP_H
+#define HEDGEDLOOKUP_H
+
+#include "dictionarybackend.h"
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QHash>
+#include <QVector>
+
+class QTimer;
+
+// Runs a lookup against an ordered chain of backends. The first backend is
+// queried immediately; the next one is fired either when the previous one
+// fails or once it has been outstanding longer than its observed p95
+// latency. The first successful answer wins and the rest are cancelled.
+class HedgedLookup : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HedgedLookup(QObject *parent = nullptr);
+
+    // Backends are queried in the order they are added; takes ownership
+    void addBackend(DictionaryBackend *backend);
+    QList<DictionaryBackend *> backends() const { return backendChain; }
+
+    void setHedgeDelayBounds(int minMs, int maxMs);
+    int hedgeDelayFor(int backendIndex) const;
+    // Whether a 404 from this backend means the word does not exist
+    bool isAuthoritative(const QString &backend) const;
+
+    quint64 lookup(const QString &word);
+    void cancel(quint64 requestId);
+
+    int hedgesFired() const { return hedgeCount; }
+    int hedgeWins() const { return hedgeWinCount; }
+
+signals:
+    void finished(const DictionaryResult &result);
+
+private:
+    struct PendingLookup
+    {
+        QString word;
+        int nextBackend = 0;
+        int outstanding = 0;
+        int firstHedgedBackend = -1;
+        QTimer *hedgeTimer = nullptr;
+        QElapsedTimer started;
+        QHash<int, qint64> firedAt;    // Backend index -> ms after start, while outstanding
+        DictionaryResult error;
+        bool hasError = false;
+    };
+
+    struct LatencyWindow
+    {
+        QVector<qint64> samples;
+        int next = 0;
+    };
+
+    void fireNext(quint64 requestId);
+    void onBackendFinished(const DictionaryResult &result);
+    // An authoritative 404 beats a transport or server error, which beats a local miss
+    int errorRank(const DictionaryResult &result) const;
+    int indexOfBackend(const QString &name) const;
+    void recordLatency(const QString &backend, qint64 elapsedMs);
+    void finish(quint64 requestId, const DictionaryResult &result);
+
+    QList<DictionaryBackend *> backendChain;
+    QHash<quint64, PendingLookup> pending;
+    QHash<QString, LatencyWindow> latencies;
+    quint64 nextRequestId;
+    int minHedgeDelayMs;
+    int maxHedgeDelayMs;
+    int hedgeCount;
+    int hedgeWinCount;
+};
+
+#endif // HEDGEDLOOKUP_H
@@ -0,0 +1,242 @@
+#include "historyexporter.h"
+#include "entryformatter.h"
+#include "historystore.h"
+#include "textkernels.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLockFile>
+#include <QVector>
+#include <QtConcurrent>
+
+namespace {
+
+// Entries held in memory at once; large enough to keep every core busy
+const int kBatchSize = 4096;
+// Runs on a worker thread, so waiting for an append to finish is fine
+const int kLockTimeoutMs = 5000;
+
+struct ExportRow
+{
+    QString timestamp;
+    QString word;
+    QString html;
+    QByteArray json;    // Cache rows carry the raw API response instead of html
+    QString output;
+};
+
+QString csvField(const QString &value)
+{
+    if (!value.contains(',') && !value.contains('"') && !value.contains('\n') && !value.contains('\r')) {
+        return value;
+    }
+    QString quoted = value;
+    quoted.replace("\"", "\"\"");
+    return "\"" + quoted + "\"";
+}
+
+QString ankiField(QString value)
+{
+    // Anki reads one note per line, fields separated by tabs
+    value.replace('\t', ' ');
+    value.replace('\r', ' ');
+    value.replace('\n', ' ');
+    return value;
+}
+
+void renderRow(ExportRow &row, HistoryExporter::Format format)
+{
+    if (!row.json.isEmpty()) {
+        QJsonArray entries = QJsonDocument::fromJson(row.json).array();
+        QJsonObject entry = entries.isEmpty() ? QJsonObject() : entries.first().toObject();
+        if (!entry.isEmpty()) {
+            row.word = entry.value("word").toString(row.word);
+            row.html = EntryFormatter::html(entry);
+        }
+        row.json.clear();
+    }
+
+    switch (format) {
+    case HistoryExporter::Markdown:
+        row.output = QString("## <font color='red'>%1</font>\n\n").arg(TextKernels::escapeHtml(row.word));
+        if (!row.timestamp.isEmpty()) {
+            row.output += QString("*Looked up %1*\n\n").arg(row.timestamp);
+        }
+        row.output += EntryFormatter::htmlToMarkdown(row.html) + "\n";
+        break;
+    case HistoryExporter::Csv:
+        row.output = csvField(row.timestamp) + "," + csvField(row.word) + ","
+                + csvField(EntryFormatter::htmlToPlainText(row.html)) + "\n";
+        break;
+    case HistoryExporter::AnkiTsv:
+        row.output = ankiField(row.word) + "\t" + ankiField(row.html) + "\n";
+        break;
+    }
+    row.html.clear();
+}
+
+class BatchWriter
+{
+public:
+    BatchWriter(const QString &outputFile, HistoryExporter::Format format)
+        : file(outputFile)
+        , exportFormat(format)
+        , written(0)
+    {
+    }
+
+    bool open(QString *errorString)
+    {
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            *errorString = file.errorString();
+            return false;
+        }
+
+        switch (exportFormat) {
+        case HistoryExporter::Markdown:
+            file.write("# Dictionary Export\n\n");
+            break;
+        case HistoryExporter::Csv:
+            file.write("timestamp,word,definition\n");
+            break;
+        case HistoryExporter::AnkiTsv:
+            file.write("#separator:tab\n#html:true\n");
+            break;
+        }
+        return true;
+    }
+
+    // Renders the batch on all cores, then appends it in its original order
+    bool writeBatch(QVector<ExportRow> &rows, QString *errorString)
+    {
+        HistoryExporter::Format format = exportFormat;
+        QtConcurrent::blockingMap(rows, [format](ExportRow &row) {
+            renderRow(row, format);
+        });
+
+        QString chunk;
+        for (const ExportRow &row : rows) {
+            chunk += row.output;
+        }
+        if (file.write(chunk.toUtf8()) < 0) {
+            *errorString = file.errorString();
+            return false;
+        }
+
+        written += rows.size();
+        rows.clear();
+        return true;
+    }
+
+    int entries() const { return written; }
+
+private:
+    QFile file;
+    HistoryExporter::Format exportFormat;
+    int written;
+};
+
+}
+
+HistoryExporter::Format HistoryExporter::formatForFileName(const QString &fileName)
+{
+    if (fileName.endsWith(".csv", Qt::CaseInsensitive)) {
+        return Csv;
+    }
+    if (fileName.endsWith(".txt", Qt::CaseInsensitive) || fileName.endsWith(".tsv", Qt::CaseInsensitive)) {
+        return AnkiTsv;
+    }
+    return Markdown;
+}
+
+ExportResult HistoryExporter::exportHistory(const QString &historyFile, const QString &outputFile, Format format)
+{
+    ExportResult result;
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(historyFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        result.errorString = "Cannot open history: " + file.errorString();
+        return result;
+    }
+
+    // Appends hold the lock for the whole line; the size seen under it ends
+    // on a line boundary. Lines appended after that are left out.
+    QLockFile lock(HistoryStore::lockPathFor(historyFile));
+    if (!lock.tryLock(kLockTimeoutMs)) {
+        result.errorString = "History is locked by another instance";
+        return result;
+    }
+    qint64 end = file.size();
+    lock.unlock();
+
+    BatchWriter writer(outputFile, format);
+    if (!writer.open(&result.errorString)) {
+        return result;
+    }
+
+    // Oldest first, parsed like HistoryStore does: raw UTF-8, whatever the locale
+    QVector<ExportRow> rows;
+    rows.reserve(kBatchSize);
+    while (file.pos() < end) {
+        QByteArray line = file.readLine();
+        if (line.endsWith('\n')) {
+            line.chop(1);
+        }
+
+        HistoryEntry entry;
+        if (HistoryStore::parseLine(line.constData(), line.size(), &entry)) {
+            ExportRow row;
+            row.timestamp = entry.timestamp;
+            row.word = entry.word;
+            row.html = entry.fullDefinition;
+            rows.append(row);
+        }
+        if (rows.size() >= kBatchSize && !writer.writeBatch(rows, &result.errorString)) {
+            return result;
+        }
+    }
+    if (!rows.isEmpty() && !writer.writeBatch(rows, &result.errorString)) {
+        return result;
+    }
+
+    result.ok = true;
+    result.entries = writer.entries();
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
+
+ExportResult HistoryExporter::exportCache(const QHash<QString, QByteArray> &cache, const QString &outputFile, Format format)
+{
+    ExportResult result;
+    QElapsedTimer timer;
+    timer.start();
+
+    BatchWriter writer(outputFile, format);
+    if (!writer.open(&result.errorString)) {
+        return result;
+    }
+
+    QVector<ExportRow> rows;
+    rows.reserve(kBatchSize);
+    for (auto it = cache.constBegin(); it != cache.constEnd(); ++it) {
+        ExportRow row;
+        row.word = it.key();
+        row.json = it.value();
+        rows.append(row);
+        if (rows.size() >= kBatchSize && !writer.writeBatch(rows, &result.errorString)) {
+            return result;
+        }
+    }
+    if (!rows.isEmpty() && !writer.writeBatch(rows, &result.errorString)) {
+        return result;
+    }
+
+    result.ok = true;
+    result.entries = writer.entries();
+    result.elapsedMs = timer.elapsed();
+    return result;
+}
@@ -0,0 +1,35 @@
+#ifndef HISTORYEXPORTER_H
+#define HISTORYEXPORTER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+struct ExportResult
+{
+    bool ok = false;
+    int entries = 0;
+    qint64 elapsedMs = 0;
+    QString errorString;
+};
+
+// Bulk export of the lookup history or the response cache. Entries are
+// read and written in fixed-size batches, so memory stays bounded no
+// matter how large the history grows; each batch is rendered in parallel
+// on the global thread pool. Safe to call from a worker thread.
+class HistoryExporter
+{
+public:
+    enum Format {
+        Markdown,
+        Csv,
+        AnkiTsv
+    };
+
+    static Format formatForFileName(const QString &fileName);
+
+    static ExportResult exportHistory(const QString &historyFile, const QString &outputFile, Format format);
+    static ExportResult exportCache(const QHash<QString, QByteArray> &cache, const QString &outputFile, Format format);
+};
+
+#endif // HISTORYEXPORTER_H
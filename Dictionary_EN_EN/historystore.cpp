@@ -0,0 +1,196 @@
+#include "historystore.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QLockFile>
+#include <QStringList>
+#include <QTimer>
+
+namespace {
+// Short enough not to stall the GUI thread
+const int kLockTimeoutMs = 20;
+const int kRetryIntervalMs = 250;
+// On exit a queued line is worth a short wait
+const int kShutdownLockTimeoutMs = 2000;
+}
+
+HistoryStore::HistoryStore(const QString &filePath, QObject *parent)
+    : QObject(parent)
+    , path(filePath)
+    , watcher(new QFileSystemWatcher(this))
+    , retryTimer(new QTimer(this))
+    , readOffset(0)
+{
+    retryTimer->setSingleShot(true);
+    retryTimer->setInterval(kRetryIntervalMs);
+    connect(retryTimer, &QTimer::timeout, this, [this]() {
+        flushQueue(kLockTimeoutMs);
+    });
+
+    watchFile();
+
+    connect(watcher, &QFileSystemWatcher::fileChanged, this, [this]() {
+        watchFile();
+        readNew();
+    });
+    connect(watcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+        watchFile();
+        readNew();
+    });
+}
+
+HistoryStore::~HistoryStore()
+{
+    // Deleted with the main window, whose widgets may already be gone
+    blockSignals(true);
+    if (!queuedLines.isEmpty()) {
+        flushQueue(kShutdownLockTimeoutMs);
+    }
+}
+
+void HistoryStore::reload()
+{
+    readOffset = 0;
+    emit reset();
+    readNew();
+}
+
+void HistoryStore::append(const HistoryEntry &entry)
+{
+    QStringList fields;
+    fields << entry.timestamp << entry.word << entry.fullDefinition << entry.shortDefinition;
+    queuedLines += fields.join("|").toUtf8() + '\n';
+
+    // Already waiting on another instance; keeps the lines in order
+    if (retryTimer->isActive()) {
+        return;
+    }
+    flushQueue(kLockTimeoutMs);
+}
+
+void HistoryStore::flushQueue(int lockTimeoutMs)
+{
+    QLockFile lock(lockPathFor(path));
+    if (!lock.tryLock(lockTimeoutMs)) {
+        retryTimer->start();
+        return;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::Append)) {
+        queuedLines.clear();
+        emit appendFailed();
+        return;
+    }
+
+    bool ok = file.write(queuedLines) == queuedLines.size();
+    file.close();
+    lock.unlock();
+    queuedLines.clear();
+    if (!ok) {
+        emit appendFailed();
+    }
+
+    // Picks up our own lines along with anything other instances appended
+    watchFile();
+    readNew();
+}
+
+void HistoryStore::watchFile()
+{
+    // The directory only until the file exists: every append creates and
+    // deletes the lock file there, which would wake every reader for nothing
+    QString directory = QFileInfo(path).absolutePath();
+    if (!QFile::exists(path)) {
+        if (!watcher->directories().contains(directory)) {
+            watcher->addPath(directory);
+        }
+        return;
+    }
+
+    // A replaced file drops out of the watch list; add it back
+    if (!watcher->files().contains(path)) {
+        watcher->addPath(path);
+    }
+    if (watcher->directories().contains(directory)) {
+        watcher->removePath(directory);
+    }
+}
+
+bool HistoryStore::parseLine(const char *data, qint64 length, HistoryEntry *entry)
+{
+    if (length > 0 && data[length - 1] == '\r') {
+        length--;
+    }
+
+    QStringList parts = QString::fromUtf8(data, int(length)).split("|");
+    if (parts.size() < 4) {
+        return false;
+    }
+    entry->timestamp = parts[0];
+    entry->word = parts[1];
+    entry->fullDefinition = parts[2];
+    entry->shortDefinition = parts[3];
+    return true;
+}
+
+void HistoryStore::readNew()
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    qint64 size = file.size();
+    if (size < readOffset) {
+        // Truncated or replaced by another instance
+        readOffset = 0;
+        emit reset();
+    }
+    if (size == readOffset) {
+        return;
+    }
+
+    qint64 length = size - readOffset;
+    QByteArray buffer;
+    const char *data = nullptr;
+    uchar *mapped = file.map(readOffset, length);
+    if (mapped) {
+        data = reinterpret_cast<const char *>(mapped);
+    } else {
+        // Some file systems cannot be mapped
+        file.seek(readOffset);
+        buffer = file.read(length);
+        data = buffer.constData();
+        length = buffer.size();
+    }
+
+    // Only whole lines; one still being written is picked up next time
+    qint64 end = length;
+    while (end > 0 && data[end - 1] != '\n') {
+        end--;
+    }
+
+    QVector<HistoryEntry> entries;
+    qint64 lineStart = 0;
+    while (lineStart < end) {
+        qint64 lineEnd = lineStart;
+        while (data[lineEnd] != '\n') {
+            lineEnd++;
+        }
+        HistoryEntry entry;
+        if (parseLine(data + lineStart, lineEnd - lineStart, &entry)) {
+            entries.append(entry);
+        }
+        lineStart = lineEnd + 1;
+    }
+
+    if (mapped) {
+        file.unmap(mapped);
+    }
+    readOffset += end;
+
+    if (!entries.isEmpty()) {
+        emit entriesAdded(entries);
+    }
+}
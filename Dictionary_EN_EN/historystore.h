@@ -0,0 +1,66 @@
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class QFileSystemWatcher;
+class QTimer;
+
+// One line of the history file: timestamp|word|html|summary
+struct HistoryEntry
+{
+    QString timestamp;
+    QString word;
+    QString fullDefinition;
+    QString shortDefinition;
+};
+
+// History file shared by every running instance. Appends hold a QLockFile
+// and write each line in a single call, so lines from two processes never
+// interleave. The lock is only tried briefly; while another instance holds
+// it, lines wait in a queue and are retried from the event loop, so the GUI
+// never blocks on it. Reads map the file and parse only the bytes past the
+// last read offset; a file watcher triggers that read, so lines appended by
+// other instances show up without reloading the whole file.
+class HistoryStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HistoryStore(const QString &filePath, QObject *parent = nullptr);
+    ~HistoryStore();
+
+    QString filePath() const { return path; }
+
+    // Reads the file from the start: reset() followed by entriesAdded()
+    void reload();
+    // Written now or, if the file is locked, shortly after
+    void append(const HistoryEntry &entry);
+
+    // One UTF-8 line without its newline; false if it lacks a field
+    static bool parseLine(const char *data, qint64 length, HistoryEntry *entry);
+    // Held while appending, so no reader sees half a line
+    static QString lockPathFor(const QString &filePath) { return filePath + ".lock"; }
+
+signals:
+    void reset();
+    // Oldest first
+    void entriesAdded(const QVector<HistoryEntry> &entries);
+    // The file could not be opened; the queued lines are dropped
+    void appendFailed();
+
+private:
+    void flushQueue(int lockTimeoutMs);
+    void readNew();
+    void watchFile();
+
+    QString path;
+    QFileSystemWatcher *watcher;
+    QTimer *retryTimer;
+    QByteArray queuedLines;
+    qint64 readOffset;
+};
+
+#endif // HISTORYSTORE_H
@@ -0,0 +1,286 @@
+#include "lemmatizer.h"
+#include <QElapsedTimer>
+#include <QStringList>
+
+namespace {
+
+struct IrregularForm
+{
+    const char *form;
+    const char *lemma;
+};
+
+// Irregular verbs, nouns and comparatives, plus regular-looking words the
+// suffix rules would otherwise mangle
+const IrregularForm kIrregularForms[] = {
+    { "am", "be" }, { "is", "be" }, { "are", "be" }, { "was", "be" }, { "were", "be" },
+    { "been", "be" }, { "being", "be" },
+    { "has", "have" }, { "had", "have" }, { "having", "have" },
+    { "does", "do" }, { "did", "do" }, { "done", "do" }, { "doing", "do" },
+    { "goes", "go" }, { "going", "go" }, { "went", "go" }, { "gone", "go" },
+    { "ran", "run" }, { "ate", "eat" }, { "eaten", "eat" },
+    { "saw", "see" }, { "seen", "see" }, { "sees", "see" },
+    { "took", "take" }, { "taken", "take" }, { "gave", "give" }, { "given", "give" },
+    { "came", "come" }, { "made", "make" }, { "said", "say" }, { "says", "say" },
+    { "knew", "know" }, { "known", "know" }, { "thought", "think" },
+    { "got", "get" }, { "gotten", "get" }, { "found", "find" }, { "told", "tell" },
+    { "became", "become" }, { "left", "leave" }, { "felt", "feel" },
+    { "brought", "bring" }, { "began", "begin" }, { "begun", "begin" },
+    { "kept", "keep" }, { "held", "hold" }, { "wrote", "write" }, { "written", "write" },
+    { "stood", "stand" }, { "heard", "hear" }, { "meant", "mean" }, { "met", "meet" },
+    { "paid", "pay" }, { "sat", "sit" }, { "spoke", "speak" }, { "spoken", "speak" },
+    { "led", "lead" }, { "grew", "grow" }, { "grown", "grow" }, { "lost", "lose" },
+    { "fell", "fall" }, { "fallen", "fall" }, { "sent", "send" }, { "built", "build" },
+    { "understood", "understand" }, { "drew", "draw" }, { "drawn", "draw" },
+    { "broke", "break" }, { "broken", "break" }, { "spent", "spend" },
+    { "rose", "rise" }, { "risen", "rise" }, { "drove", "drive" }, { "driven", "drive" },
+    { "bought", "buy" }, { "wore", "wear" }, { "worn", "wear" }, { "chose", "choose" },
+    { "chosen", "choose" }, { "sought", "seek" }, { "threw", "throw" }, { "thrown", "throw" },
+    { "caught", "catch" }, { "dealt", "deal" }, { "won", "win" }, { "forgot", "forget" },
+    { "forgotten", "forget" }, { "sold", "sell" }, { "fought", "fight" },
+    { "flew", "fly" }, { "flown", "fly" }, { "sang", "sing" }, { "sung", "sing" },
+    { "swam", "swim" }, { "swum", "swim" }, { "drank", "drink" }, { "drunk", "drink" },
+    { "rang", "ring" }, { "rung", "ring" }, { "taught", "teach" }, { "slept", "sleep" },
+    { "woke", "wake" }, { "woken", "wake" }, { "hid", "hide" }, { "hidden", "hide" },
+    { "bit", "bite" }, { "bitten", "bite" }, { "shook", "shake" }, { "shaken", "shake" },
+    { "stole", "steal" }, { "stolen", "steal" }, { "froze", "freeze" }, { "frozen", "freeze" },
+    { "fed", "feed" }, { "fled", "flee" }, { "lay", "lie" }, { "lain", "lie" },
+    { "laid", "lay" }, { "rode", "ride" }, { "ridden", "ride" }, { "shot", "shoot" },
+    { "struck", "strike" }, { "swore", "swear" }, { "sworn", "swear" },
+    { "tore", "tear" }, { "torn", "tear" }, { "wept", "weep" }, { "wound", "wind" },
+    { "used", "use" }, { "uses", "use" },
+    { "dies", "die" }, { "died", "die" }, { "dying", "die" },
+    { "lies", "lie" }, { "lied", "lie" }, { "lying", "lie" },
+    { "ties", "tie" }, { "tied", "tie" }, { "tying", "tie" },
+    { "men", "man" }, { "women", "woman" }, { "children", "child" }, { "people", "person" },
+    { "feet", "foot" }, { "teeth", "tooth" }, { "geese", "goose" }, { "mice", "mouse" },
+    { "lice", "louse" }, { "oxen", "ox" }, { "knives", "knife" }, { "wives", "wife" },
+    { "lives", "life" }, { "leaves", "leaf" }, { "halves", "half" }, { "wolves", "wolf" },
+    { "shelves", "shelf" }, { "selves", "self" }, { "loaves", "loaf" }, { "thieves", "thief" },
+    { "data", "datum" }, { "criteria", "criterion" }, { "phenomena", "phenomenon" },
+    { "analyses", "analysis" }, { "crises", "crisis" }, { "theses", "thesis" },
+    { "cacti", "cactus" }, { "fungi", "fungus" }, { "radii", "radius" },
+    { "better", "good" }, { "best", "good" }, { "worse", "bad" }, { "worst", "bad" },
+    { "more", "many" }, { "most", "many" }, { "less", "little" }, { "least", "little" },
+    { "further", "far" }, { "furthest", "far" }, { "farther", "far" }, { "farthest", "far" },
+    { "news", "news" }, { "series", "series" }, { "species", "species" },
+    { "thing", "thing" }, { "nothing", "nothing" }, { "something", "something" },
+    { "everything", "everything" }, { "anything", "anything" }, { "morning", "morning" },
+    { "evening", "evening" }, { "ceiling", "ceiling" }, { "during", "during" },
+    { "always", "always" }, { "perhaps", "perhaps" }, { "this", "this" },
+};
+
+const int kMinLemmaLength = 3;
+
+inline bool isVowel(const QString &word, int i)
+{
+    switch (word.at(i).unicode()) {
+    case 'a': case 'e': case 'i': case 'o': case 'u':
+        return true;
+    case 'y':
+        // 'y' is a vowel when it follows a consonant ("fly", "cycle")
+        return i > 0 && !isVowel(word, i - 1);
+    default:
+        return false;
+    }
+}
+
+bool containsVowel(const QString &word, int length)
+{
+    for (int i = 0; i < length; ++i) {
+        if (isVowel(word, i)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Porter "measure": the number of vowel-consonant sequences in the stem
+int measure(const QString &word, int length)
+{
+    int m = 0;
+    bool previousVowel = false;
+    for (int i = 0; i < length; ++i) {
+        bool vowel = isVowel(word, i);
+        if (previousVowel && !vowel) {
+            m++;
+        }
+        previousVowel = vowel;
+    }
+    return m;
+}
+
+// Consonant-vowel-consonant ending where the last consonant is not w, x or y
+bool endsWithCvc(const QString &word)
+{
+    int n = word.size();
+    if (n < 3) {
+        return false;
+    }
+    QChar last = word.at(n - 1);
+    return !isVowel(word, n - 3) && isVowel(word, n - 2) && !isVowel(word, n - 1)
+            && last != QLatin1Char('w') && last != QLatin1Char('x') && last != QLatin1Char('y');
+}
+
+bool endsWithDoubleConsonant(const QString &word)
+{
+    int n = word.size();
+    return n >= 2 && word.at(n - 1) == word.at(n - 2) && !isVowel(word, n - 1);
+}
+
+bool isPlainWord(const QString &word)
+{
+    for (QChar c : word) {
+        if (c < QLatin1Char('a') || c > QLatin1Char('z')) {
+            return false;
+        }
+    }
+    return !word.isEmpty();
+}
+
+// Tidies a stem after "-ed"/"-ing" removal (Porter step 1b)
+QString restoreStem(QString stem)
+{
+    if (stem.endsWith(QLatin1String("at")) || stem.endsWith(QLatin1String("bl"))
+            || stem.endsWith(QLatin1String("iz"))) {
+        return stem + QLatin1Char('e');
+    }
+    if (endsWithDoubleConsonant(stem)) {
+        QChar last = stem.at(stem.size() - 1);
+        if (last != QLatin1Char('l') && last != QLatin1Char('s') && last != QLatin1Char('z')) {
+            stem.chop(1);
+        }
+        return stem;
+    }
+    if (measure(stem, stem.size()) == 1 && endsWithCvc(stem)) {
+        return stem + QLatin1Char('e');
+    }
+    return stem;
+}
+
+}
+
+Lemmatizer::Lemmatizer()
+    : recordedCount(0)
+    , rawRepeatCount(0)
+    , lemmaRepeatCount(0)
+{
+    for (const IrregularForm &entry : kIrregularForms) {
+        irregularForms.insert(QString::fromLatin1(entry.form), QString::fromLatin1(entry.lemma));
+    }
+}
+
+QString Lemmatizer::normalize(const QString &word)
+{
+    return word.trimmed().toLower();
+}
+
+QString Lemmatizer::lemma(const QString &word) const
+{
+    QString key = normalize(word);
+
+    auto it = irregularForms.constFind(key);
+    if (it != irregularForms.constEnd()) {
+        return it.value();
+    }
+
+    // Phrases, hyphenated and non-ASCII words are left as typed
+    if (key.size() <= kMinLemmaLength || !isPlainWord(key)) {
+        return key;
+    }
+
+    return applySuffixRules(key);
+}
+
+QString Lemmatizer::applySuffixRules(const QString &word) const
+{
+    int n = word.size();
+
+    // Plurals and third person singular
+    if (word.endsWith(QLatin1String("sses"))) {
+        return word.left(n - 2);
+    }
+    if (word.endsWith(QLatin1String("ies")) && n > 4) {
+        return word.left(n - 3) + QLatin1Char('y');
+    }
+    if (word.endsWith(QLatin1String("ches")) || word.endsWith(QLatin1String("shes"))
+            || word.endsWith(QLatin1String("xes")) || word.endsWith(QLatin1String("zzes"))) {
+        return word.left(n - 2);
+    }
+    if (word.endsWith(QLatin1Char('s')) && !word.endsWith(QLatin1String("ss"))
+            && !word.endsWith(QLatin1String("us")) && !word.endsWith(QLatin1String("is"))) {
+        return word.left(n - 1);
+    }
+
+    // Past tense and participles
+    if (word.endsWith(QLatin1String("eed"))) {
+        return measure(word, n - 3) > 0 ? word.left(n - 1) : word;
+    }
+    if (word.endsWith(QLatin1String("ied")) && n > 4) {
+        return word.left(n - 3) + QLatin1Char('y');
+    }
+    if (word.endsWith(QLatin1String("ed")) && containsVowel(word, n - 2)) {
+        return restoreStem(word.left(n - 2));
+    }
+    if (word.endsWith(QLatin1String("ing")) && n > 5 && containsVowel(word, n - 3)) {
+        return restoreStem(word.left(n - 3));
+    }
+
+    return word;
+}
+
+void Lemmatizer::recordKey(const QString &word)
+{
+    QString raw = word.trimmed().toLower();
+    QString key = lemma(raw);
+
+    recordedCount++;
+    if (seenRawKeys.contains(raw)) {
+        rawRepeatCount++;
+    } else {
+        seenRawKeys.insert(raw);
+    }
+    if (seenLemmaKeys.contains(key)) {
+        lemmaRepeatCount++;
+    } else {
+        seenLemmaKeys.insert(key);
+    }
+}
+
+double Lemmatizer::rawHitRate() const
+{
+    return recordedCount > 0 ? double(rawRepeatCount) / recordedCount : 0.0;
+}
+
+double Lemmatizer::lemmaHitRate() const
+{
+    return recordedCount > 0 ? double(lemmaRepeatCount) / recordedCount : 0.0;
+}
+
+QString Lemmatizer::statsSummary() const
+{
+    // The cache is keyed by typed form; the lemma figure is what keying by lemma would give
+    return QString("Repeated lookups %1% by typed form; keyed by lemma it would be %2% (+%3%)")
+            .arg(rawHitRate() * 100, 0, 'f', 1)
+            .arg(lemmaHitRate() * 100, 0, 'f', 1)
+            .arg((lemmaHitRate() - rawHitRate()) * 100, 0, 'f', 1);
+}
+
+QString Lemmatizer::benchmark(int iterations) const
+{
+    const QStringList words = {
+        "ran", "better", "children", "running", "studies", "hoped", "agreed",
+        "dictionary", "pronunciation", "boxes", "walked", "quickly"
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    int checksum = 0;
+    for (int i = 0; i < iterations; ++i) {
+        checksum += lemma(words.at(i % words.size())).size();
+    }
+    qint64 ns = timer.nsecsElapsed() / qMax(1, iterations);
+
+    return QString("Lemmatizer: %1 ns/call over %2 calls (checksum %3)")
+            .arg(ns).arg(iterations).arg(checksum);
+}
@@ -0,0 +1,45 @@
+#ifndef LEMMATIZER_H
+#define LEMMATIZER_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+// Maps inflected English words to a canonical lemma ("ran", "runs",
+// "running" -> "run"), used to retry words the API does not know and to
+// measure how often lookups share a lemma. Irregular forms come from a
+// table; everything else goes through a short list of suffix rules, whose
+// output is a stem rather than always a real word. No regular expressions:
+// a call costs a hash lookup plus a few suffix compares; benchmark() times it.
+class Lemmatizer
+{
+public:
+    Lemmatizer();
+
+    QString lemma(const QString &word) const;
+    // Trimmed and lower-cased; the key for cache, history and audio
+    static QString normalize(const QString &word);
+
+    // Hit-rate accounting: counts how often a key repeats when keyed by the
+    // raw input versus by its lemma, to show what keying by lemma would buy
+    void recordKey(const QString &word);
+    int keysRecorded() const { return recordedCount; }
+    double rawHitRate() const;
+    double lemmaHitRate() const;
+    QString statsSummary() const;
+
+    // Average time of lemma() over a mix of irregular, inflected and plain words
+    QString benchmark(int iterations = 200000) const;
+
+private:
+    QString applySuffixRules(const QString &word) const;
+
+    QHash<QString, QString> irregularForms;
+    QSet<QString> seenRawKeys;
+    QSet<QString> seenLemmaKeys;
+    int recordedCount;
+    int rawRepeatCount;
+    int lemmaRepeatCount;
+};
+
+#endif // LEMMATIZER_H
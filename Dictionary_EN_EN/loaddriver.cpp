@@ -0,0 +1,181 @@
+#include "loaddriver.h"
+#include "mainwindow.h"
+#include "mockdictionaryserver.h"
+#include <QFile>
+#include <QStringList>
+#include <QTimer>
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+namespace {
+
+const int kTickIntervalMs = 10;
+const qint64 kDrainTimeoutMs = 10000;
+
+qint64 residentMemoryKb()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.WorkingSetSize / 1024);
+    }
+#elif defined(Q_OS_LINUX)
+    QFile status("/proc/self/status");
+    if (status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        for (const QByteArray &line : status.readAll().split('\n')) {
+            if (line.startsWith("VmRSS:")) {
+                return line.mid(6).trimmed().split(' ').first().toLongLong();
+            }
+        }
+    }
+#endif
+    return 0;
+}
+
+QString latencySummary(QVector<qint64> samples)
+{
+    if (samples.isEmpty()) {
+        return "n/a";
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](int p) {
+        int rank = qMax(0, (samples.size() * p + 99) / 100 - 1);
+        return samples[rank];
+    };
+    return QString("p50 %1 ms, p95 %2 ms, p99 %3 ms, max %4 ms")
+            .arg(percentile(50)).arg(percentile(95)).arg(percentile(99)).arg(samples.last());
+}
+
+}
+
+LoadDriver::LoadDriver(MainWindow *window, QObject *parent)
+    : QObject(parent)
+    , window(window)
+    , server(nullptr)
+    , tickTimer(new QTimer(this))
+    , rate(0)
+    , durationMs(0)
+    , ttsEnabled(false)
+    , draining(false)
+    , issuedLookups(0)
+    , failedLookups(0)
+    , failedPronunciations(0)
+    , startMemoryKb(0)
+    , peakMemoryKb(0)
+    , elapsedAtFinish(0)
+{
+    connect(tickTimer, &QTimer::timeout, this, &LoadDriver::tick);
+    connect(window, &MainWindow::lookupCompleted, this, &LoadDriver::onLookupCompleted);
+    connect(window, &MainWindow::pronunciationCompleted, this, &LoadDriver::onPronunciationCompleted);
+}
+
+void LoadDriver::start(int lookupsPerSecond, int durationSeconds, bool withTts)
+{
+    rate = qMax(1, lookupsPerSecond);
+    durationMs = qint64(qMax(1, durationSeconds)) * 1000;
+    ttsEnabled = withTts;
+
+    // Superseding in-flight lookups would hide most of the load; playback
+    // and clipboard copies would hit the user's desktop once per lookup
+    window->setConcurrentLookups(true);
+    window->setUnattended(true);
+
+    startMemoryKb = residentMemoryKb();
+    peakMemoryKb = startMemoryKb;
+    clock.start();
+    tickTimer->start(kTickIntervalMs);
+}
+
+void LoadDriver::tick()
+{
+    qint64 elapsed = clock.elapsed();
+    peakMemoryKb = qMax(peakMemoryKb, residentMemoryKb());
+
+    if (!draining) {
+        // Issue whatever the schedule says should have gone out by now
+        int due = int(qMin(elapsed, durationMs) * rate / 1000);
+        while (issuedLookups < due) {
+            QString word = QString("loadtest%1").arg(issuedLookups++);
+            lookupStarts.insert(word, clock.elapsed());
+            window->lookupWord(word);
+            if (ttsEnabled) {
+                ttsStarts.insert(word, clock.elapsed());
+                window->pronounceWord(word);
+            }
+        }
+        if (elapsed >= durationMs) {
+            draining = true;
+        }
+    }
+
+    if (draining && ((lookupStarts.isEmpty() && ttsStarts.isEmpty()) || elapsed >= durationMs + kDrainTimeoutMs)) {
+        finish();
+    }
+}
+
+void LoadDriver::onLookupCompleted(const QString &word, bool ok)
+{
+    auto it = lookupStarts.find(word);
+    if (it == lookupStarts.end()) {
+        return;
+    }
+    lookupLatencies.append(clock.elapsed() - it.value());
+    lookupStarts.erase(it);
+    if (!ok) {
+        failedLookups++;
+    }
+}
+
+void LoadDriver::onPronunciationCompleted(const QString &word, bool ok)
+{
+    auto it = ttsStarts.find(word);
+    if (it == ttsStarts.end()) {
+        return;
+    }
+    ttsLatencies.append(clock.elapsed() - it.value());
+    ttsStarts.erase(it);
+    if (!ok) {
+        failedPronunciations++;
+    }
+}
+
+void LoadDriver::finish()
+{
+    tickTimer->stop();
+    elapsedAtFinish = clock.elapsed();
+    window->setConcurrentLookups(false);
+    window->setUnattended(false);
+    emit finished(report());
+}
+
+QString LoadDriver::report() const
+{
+    double seconds = qMax<qint64>(1, elapsedAtFinish) / 1000.0;
+    qint64 endMemoryKb = residentMemoryKb();
+
+    QStringList lines;
+    lines << QString("Load test: %1 lookups/s for %2 s%3")
+             .arg(rate).arg(durationMs / 1000).arg(ttsEnabled ? " with TTS" : "");
+    lines << QString("Lookups: %1 issued, %2 completed, %3 failed, %4 timed out, %5/s throughput")
+             .arg(issuedLookups).arg(lookupLatencies.size()).arg(failedLookups).arg(lookupStarts.size())
+             .arg(lookupLatencies.size() / seconds, 0, 'f', 1);
+    lines << "Lookup latency: " + latencySummary(lookupLatencies);
+    if (ttsEnabled) {
+        lines << QString("TTS: %1 completed, %2 failed, %3 timed out")
+                 .arg(ttsLatencies.size()).arg(failedPronunciations).arg(ttsStarts.size());
+        lines << "TTS latency: " + latencySummary(ttsLatencies);
+    }
+    lines << QString("Memory: %1 KB at start, %2 KB peak, %3 KB at end (%4%5 KB)")
+             .arg(startMemoryKb).arg(peakMemoryKb).arg(endMemoryKb)
+             .arg(endMemoryKb >= startMemoryKb ? "+" : "").arg(endMemoryKb - startMemoryKb);
+    lines << window->statsSummary();
+    if (server) {
+        lines << QString("Mock server: %1 responses, %2 injected errors, %3 rate limited")
+                 .arg(server->requestsServed()).arg(server->errorsInjected()).arg(server->requestsRateLimited());
+    }
+    return lines.join("\n");
+}
@@ -0,0 +1,62 @@
+#ifndef LOADDRIVER_H
+#define LOADDRIVER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+class MainWindow;
+class MockDictionaryServer;
+class QTimer;
+
+// Pushes a steady rate of lookups (and optionally pronunciations) through
+// MainWindow's real lookup and TTS paths, then reports throughput, tail
+// latency and resident memory growth.
+class LoadDriver : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LoadDriver(MainWindow *window, QObject *parent = nullptr);
+
+    // Optional; adds the server's injected error counts to the report
+    void setServer(MockDictionaryServer *mockServer) { server = mockServer; }
+
+    void start(int lookupsPerSecond, int durationSeconds, bool withTts);
+
+signals:
+    void finished(const QString &report);
+
+private:
+    void tick();
+    void onLookupCompleted(const QString &word, bool ok);
+    void onPronunciationCompleted(const QString &word, bool ok);
+    void finish();
+    QString report() const;
+
+    MainWindow *window;
+    MockDictionaryServer *server;
+    QTimer *tickTimer;
+    QElapsedTimer clock;
+
+    int rate;
+    qint64 durationMs;
+    bool ttsEnabled;
+    bool draining;
+
+    int issuedLookups;
+    int failedLookups;
+    int failedPronunciations;
+    QHash<QString, qint64> lookupStarts;
+    QHash<QString, qint64> ttsStarts;
+    QVector<qint64> lookupLatencies;
+    QVector<qint64> ttsLatencies;
+
+    qint64 startMemoryKb;
+    qint64 peakMemoryKb;
+    qint64 elapsedAtFinish;
+};
+
+#endif // LOADDRIVER_H
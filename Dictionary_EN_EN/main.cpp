@@ -1,7 +1,71 @@
 #include "mainwindow.h"
+#include "mockdictionaryserver.h"
+#include "loaddriver.h"
+#include "textkernels.h"
+#include "lemmatizer.h"
 #include <QApplication>
 #include <QStyleFactory>
 #include <QFile>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+// Drives the real lookup/TTS paths against a local mock server and prints a report
+static int runLoadTest(QApplication &app, const QCommandLineParser &parser)
+{
+    MockDictionaryServer server;
+    if (!server.listen()) {
+        QTextStream(stderr) << "Load test: cannot start mock server\n";
+        return 1;
+    }
+    if (parser.isSet("recordings")) {
+        server.loadRecordings(parser.value("recordings"));
+    }
+    server.setLatency(parser.value("latency").toInt(), parser.value("jitter").toInt());
+    server.setErrorRate(parser.value("error-rate").toDouble());
+    server.setRateLimit(parser.value("rate-limit").toInt());
+
+    // Point every endpoint at the mock and keep the user's history and audio untouched
+    QTemporaryDir workDir;
+    QString settingsPath = workDir.filePath("loadtest_settings.ini");
+    {
+        QSettings settings(settingsPath, QSettings::IniFormat);
+        settings.setValue("backends/primaryUrl", server.dictionaryUrlTemplate());
+        settings.setValue("backends/localFile", workDir.filePath("no_local_dictionary.json"));
+        settings.setValue("tts/urlTemplate", server.ttsUrlTemplate());
+        settings.setValue("paths/historyFile", workDir.filePath("history.txt"));
+        settings.setValue("paths/audioDirectory", workDir.filePath("word_audio"));
+        settings.setValue("paths/synonymGraphFile", workDir.filePath("synonym_graph.bin"));
+        settings.setValue("paths/responseCacheFile", workDir.filePath("response_cache.bin"));
+        settings.setValue("paths/negativeCacheFile", workDir.filePath("negative_cache.bin"));
+    }
+
+    MainWindow window(nullptr, settingsPath);
+    window.show();
+
+    LoadDriver driver(&window);
+    driver.setServer(&server);
+    // The report goes where asked, else to the system temp directory, never the working directory
+    QString reportPath = parser.value("report");
+    if (reportPath.isEmpty()) {
+        reportPath = QDir::temp().filePath("dictionary_load_test_report.txt");
+    }
+    QObject::connect(&driver, &LoadDriver::finished, &app, [&app, reportPath](const QString &report) {
+        QTextStream(stdout) << report << "\n";
+
+        QFile reportFile(reportPath);
+        if (reportFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            reportFile.write(report.toUtf8() + "\n");
+            QTextStream(stdout) << "Report written to " << QDir::toNativeSeparators(reportPath) << "\n";
+        }
+        app.quit();
+    });
+
+    driver.start(parser.value("rate").toInt(), parser.value("duration").toInt(), parser.isSet("tts"));
+    return app.exec();
+}
 
 int main(int argc, char *argv[])
 {
@@ -40,6 +104,31 @@ int main(int argc, char *argv[])
     // Set modern style
     app.setStyle(QStyleFactory::create("Fusion"));
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOptions({
+        { "load-test", "Run a load test against a local mock server and exit." },
+        { "rate", "Lookups per second.", "n", "20" },
+        { "duration", "Load test duration in seconds.", "seconds", "10" },
+        { "latency", "Mock server base latency.", "ms", "50" },
+        { "jitter", "Mock server random extra latency.", "ms", "0" },
+        { "error-rate", "Fraction of requests answered with 500.", "fraction", "0" },
+        { "rate-limit", "Requests per second before the mock answers 429.", "n", "0" },
+        { "recordings", "Directory of recorded <word>.json replies and tts.mp3.", "dir" },
+        { "tts", "Also download a pronunciation for every lookup." },
+        { "report", "Where to write the load test report.", "file" },
+        { "benchmark-text", "Time the HTML text kernels and the lemmatizer and exit." }
+    });
+    parser.process(app);
+
+    if (parser.isSet("load-test")) {
+        return runLoadTest(app, parser);
+    }
+    if (parser.isSet("benchmark-text")) {
+        QTextStream(stdout) << TextKernels::benchmark() << "\n" << Lemmatizer().benchmark() << "\n";
+        return 0;
+    }
+
     // Create and show main window
     MainWindow window;
     window.show();
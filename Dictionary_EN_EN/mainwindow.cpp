@@ -18,17 +18,53 @@
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QTimer>
-
-MainWindow::MainWindow(QWidget *parent)
+#include <QSettings>
+#include <QMenu>
+#include <QFileDialog>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <QSaveFile>
+#include "entryformatter.h"
+#include "historyexporter.h"
+#include "sharedjournal.h"
+
+MainWindow::MainWindow(QWidget *parent, const QString &settingsPath)
     : QMainWindow(parent)
-    , historyFile("english_word_history.txt")
-    , networkManager(new QNetworkAccessManager(this))
+    , dictionaryLookup(new HedgedLookup(this))
+    , currentRequestId(0)
+    , concurrentLookups(false)
+    , unattended(false)
+    , ttsUrlTemplate("https://translate.google.com/translate_tts?ie=UTF-8&tl=%1&client=tw-ob&q=%2")
     , ttsNetworkManager(new QNetworkAccessManager(this))
+    , entryRenderer(new EntryRenderer(this))
+    , historyFile("english_word_history.txt")
+    , historyStore(nullptr)
+    , settingsFile(settingsPath)
+    , audioDirectory("word_audio")
+    , cacheRevalidator(nullptr)
+    , responseCacheFile("response_cache.bin")
+    , negativeCacheFile("negative_cache.bin")
+    , synonymGraphFile("synonym_graph.bin")
 {
+    loadSettings();
     setupUI();
 
-    connect(networkManager, &QNetworkAccessManager::finished, this, &MainWindow::onNetworkReply);
+    // Shared with other running instances; their lookups appear in the list too
+    historyStore = new HistoryStore(historyFile, this);
+    connect(historyStore, &HistoryStore::reset, this, &MainWindow::onHistoryReset);
+    connect(historyStore, &HistoryStore::entriesAdded, this, &MainWindow::onHistoryEntriesAdded);
+    connect(historyStore, &HistoryStore::appendFailed, this, [this]() {
+        statusLabel->setText("Could not save history to " + historyStore->filePath());
+    });
+    synonymGraph.load(synonymGraphFile);
+    // Both caches log changes next to their files, so other instances see them at once
+    responseCache.load(responseCacheFile);
+    responseCache.attachJournal(new SharedJournal(responseCacheFile, this));
+    setupBackends();
+
+    connect(dictionaryLookup, &HedgedLookup::finished, this, &MainWindow::onLookupFinished);
     connect(ttsNetworkManager, &QNetworkAccessManager::finished, this, &MainWindow::onTtsReply);
+    connect(entryRenderer, &EntryRenderer::rendered, this, &MainWindow::onEntryRendered);
 
     // Setup media player for audio playback
     mediaPlayer = new QMediaPlayer(this);
@@ -52,7 +88,7 @@ MainWindow::MainWindow(QWidget *parent)
     #endif
 
     // Create word_audio directory if it doesn't exist
-    QDir audioDir("word_audio");
+    QDir audioDir(audioDirectory);
     if (!audioDir.exists()) {
         audioDir.mkpath(".");
     }
@@ -63,6 +99,28 @@ MainWindow::MainWindow(QWidget *parent)
 MainWindow::~MainWindow()
 {
     // QObjects are automatically deleted
+    if (synonymGraph.isModified()) {
+        synonymGraph.save(synonymGraphFile);
+    }
+    if (responseCache.isModified()) {
+        responseCache.save(responseCacheFile);
+    }
+    if (negativeCache.isModified()) {
+        negativeCache.save(negativeCacheFile);
+    }
+}
+
+void MainWindow::loadSettings()
+{
+    // File locations and the TTS endpoint; the defaults match the original hard-coded values
+    QSettings settings(settingsFile, QSettings::IniFormat);
+
+    historyFile = settings.value("paths/historyFile", historyFile).toString();
+    audioDirectory = settings.value("paths/audioDirectory", audioDirectory).toString();
+    synonymGraphFile = settings.value("paths/synonymGraphFile", synonymGraphFile).toString();
+    responseCacheFile = settings.value("paths/responseCacheFile", responseCacheFile).toString();
+    negativeCacheFile = settings.value("paths/negativeCacheFile", negativeCacheFile).toString();
+    ttsUrlTemplate = settings.value("tts/urlTemplate", ttsUrlTemplate).toString();
 }
 
 void MainWindow::setupUI()
@@ -108,8 +166,9 @@ void MainWindow::setupUI()
     QLabel *lookupLabel = new QLabel("Lookup Result - English Dictionary", leftPanel);
     lookupLabel->setStyleSheet("QLabel { font-weight: bold; font-size: 12px; padding: 5px; background-color: #e0e0e0; }");
 
-    resultDisplay = new QTextEdit(leftPanel);
+    resultDisplay = new QTextBrowser(leftPanel);
     resultDisplay->setReadOnly(true);
+    resultDisplay->setOpenLinks(false);
     resultDisplay->setStyleSheet("QTextEdit { background-color: #f5f5f5; padding: 10px; font-size: 12px; }");
 
     QHBoxLayout *buttonLayout = new QHBoxLayout();
@@ -141,17 +200,28 @@ void MainWindow::setupUI()
     QLabel *historyDetailLabel = new QLabel("History Detail", rightPanel);
     historyDetailLabel->setStyleSheet("QLabel { font-weight: bold; font-size: 12px; padding: 5px; background-color: #e0e0e0; }");
 
-    historyDetailDisplay = new QTextEdit(rightPanel);
+    historyDetailDisplay = new QTextBrowser(rightPanel);
     historyDetailDisplay->setReadOnly(true);
+    historyDetailDisplay->setOpenLinks(false);
     historyDetailDisplay->setStyleSheet("QTextEdit { background-color: #f8f8f8; padding: 10px; font-size: 11px; border: 1px solid #ccc; }");
 
     copyHistoryButton = new QPushButton("Copy as Markdown", rightPanel);
 
+    exportButton = new QPushButton("Export...", rightPanel);
+    QMenu *exportMenu = new QMenu(exportButton);
+    exportMenu->addAction("Export History...", this, &MainWindow::exportHistory);
+    exportMenu->addAction("Export Cache...", this, &MainWindow::exportCache);
+    exportButton->setMenu(exportMenu);
+
+    QHBoxLayout *historyButtonLayout = new QHBoxLayout();
+    historyButtonLayout->addWidget(copyHistoryButton);
+    historyButtonLayout->addWidget(exportButton);
+
     rightLayout->addWidget(historyLabel);
     rightLayout->addWidget(historyList);
     rightLayout->addWidget(historyDetailLabel);
     rightLayout->addWidget(historyDetailDisplay);
-    rightLayout->addWidget(copyHistoryButton);
+    rightLayout->addLayout(historyButtonLayout);
 
     mainSplitter->addWidget(leftPanel);
     mainSplitter->addWidget(rightPanel);
@@ -171,10 +241,76 @@ void MainWindow::setupUI()
     connect(copyButton, &QPushButton::clicked, this, &MainWindow::copyToClipboard);
     connect(copyHistoryButton, &QPushButton::clicked, this, &MainWindow::copyHistoryToClipboard);
     connect(historyList, &QListWidget::itemClicked, this, &MainWindow::onHistoryItemClicked);
+    connect(resultDisplay, &QTextBrowser::anchorClicked, this, &MainWindow::onWordLinkClicked);
+    connect(historyDetailDisplay, &QTextBrowser::anchorClicked, this, &MainWindow::onWordLinkClicked);
 
     wordInput->setFocus();
 }
 
+void MainWindow::setupBackends()
+{
+    // Backends are listed in dictionary_settings.ini; missing keys fall back to defaults
+    QSettings settings(settingsFile, QSettings::IniFormat);
+    settings.beginGroup("backends");
+
+    QString localFile = settings.value("localFile", "local_dictionary.json").toString();
+    QString primaryUrl = settings.value("primaryUrl", "https://api.dictionaryapi.dev/api/v2/entries/en/%1").toString();
+    QString secondaryUrl = settings.value("secondaryUrl").toString();
+    int minHedgeDelay = settings.value("minHedgeDelayMs", 50).toInt();
+    int maxHedgeDelay = settings.value("maxHedgeDelayMs", 3000).toInt();
+
+    settings.endGroup();
+
+    // Stored responses stay fresh for a week and are served stale for up to a year
+    qint64 freshTtlHours = settings.value("cache/freshTtlHours", 7 * 24).toLongLong();
+    qint64 maxStaleDays = settings.value("cache/maxStaleDays", 365).toLongLong();
+    responseCache.setTtl(freshTtlHours * 3600, maxStaleDays * 24 * 3600);
+
+    // Misses are remembered for a day; the TTL must be set before loading drops expired ones
+    qint64 negativeTtlHours = settings.value("cache/negativeTtlHours", 24).toLongLong();
+    negativeCache.setTtl(negativeTtlHours * 3600);
+    negativeCache.load(negativeCacheFile);
+    negativeCache.attachJournal(new SharedJournal(negativeCacheFile, this));
+
+    // Local file first: it answers instantly and a miss falls through straight away
+    LocalFileDictionaryBackend *localBackend = new LocalFileDictionaryBackend("local", localFile);
+    if (localBackend->isLoaded()) {
+        // Seed a fresh synonym graph from the imported entries
+        if (synonymGraph.wordCount() == 0) {
+            const QHash<QString, QByteArray> &entries = localBackend->entryData();
+            for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+                synonymGraph.addEntries(QJsonDocument::fromJson(it.value()).array());
+            }
+        }
+        dictionaryLookup->addBackend(localBackend);
+    } else {
+        delete localBackend;
+    }
+
+    dictionaryLookup->addBackend(new HttpDictionaryBackend("primary", primaryUrl));
+
+    // The secondary is only fired once the primary exceeds its p95 latency
+    if (!secondaryUrl.isEmpty()) {
+        dictionaryLookup->addBackend(new HttpDictionaryBackend("secondary", secondaryUrl));
+    }
+
+    dictionaryLookup->setHedgeDelayBounds(minHedgeDelay, maxHedgeDelay);
+
+    cacheRevalidator = new CacheRevalidator(&responseCache, "primary", primaryUrl, this);
+    cacheRevalidator->start();
+}
+
+void MainWindow::lookupWord(const QString &word)
+{
+    wordInput->setText(word);
+    onLookupWord();
+}
+
+void MainWindow::pronounceWord(const QString &word)
+{
+    downloadAndPlayAudio(word, "en");
+}
+
 void MainWindow::onLookupWord()
 {
     QString word = wordInput->text().trimmed();
@@ -184,6 +320,39 @@ void MainWindow::onLookupWord()
     }
 
     currentWord = word;
+    lemmatizer.recordKey(word);
+
+    // Keyed by the typed form: a lemma can be a different word ("better" ->
+    // "good") or not a word at all, so it is only used to retry a 404
+    QString cacheKey = Lemmatizer::normalize(word);
+    ResponseCache::Freshness freshness = responseCache.freshness(cacheKey);
+    if (freshness == ResponseCache::Fresh || freshness == ResponseCache::Stale) {
+        cancelCurrentLookup();
+        lookupProgressBar->setVisible(false);
+        currentAudioUrl.clear();
+
+        // Stale entries are shown right away and refreshed in the background
+        if (freshness == ResponseCache::Stale) {
+            cacheRevalidator->enqueue(cacheKey);
+        }
+        statusLabel->setToolTip(statsSummary());
+        startRender(word, responseCache.value(cacheKey).data, true);
+        return;
+    }
+
+    // So are words the API already answered with "not found"
+    if (negativeCache.contains(cacheKey)) {
+        cancelCurrentLookup();
+        lookupProgressBar->setVisible(false);
+        currentAudioUrl.clear();
+
+        resultDisplay->setText("Word not found in dictionary.");
+        statusLabel->setText("Not found (cached) - " + QDateTime::currentDateTime().toString("hh:mm:ss"));
+        statusLabel->setToolTip(statsSummary());
+        pronounceButton->setEnabled(false);
+        emit lookupCompleted(word, false);
+        return;
+    }
 
     // Show lookup progress
     lookupProgressBar->setVisible(true);
@@ -192,164 +361,168 @@ void MainWindow::onLookupWord()
     pronounceButton->setEnabled(false);
     currentAudioUrl.clear();
 
-    // Use dictionaryapi.dev for English-English definitions
-    QString url = QString("https://api.dictionaryapi.dev/api/v2/entries/en/%1").arg(word);
-    networkManager->get(QNetworkRequest(QUrl(url)));
+    cancelCurrentLookup();
+    currentRequestId = dictionaryLookup->lookup(word);
+    pendingWords.insert(currentRequestId, word);
+    cacheRevalidator->setForegroundActive(true);
 }
 
-void MainWindow::onNetworkReply(QNetworkReply *reply)
+void MainWindow::cancelCurrentLookup()
 {
-    lookupProgressBar->setVisible(false);
-
-    if (reply->error() == QNetworkReply::NoError) {
-        QByteArray data = reply->readAll();
-        parseDictionaryResponse(data);
-
-        // Auto-play audio if checkbox is checked
-        if (autoPlayCheckbox->isChecked() && !currentWord.isEmpty()) {
-            downloadAndPlayAudio(currentWord, "en");
-        }
-    } else {
-        resultDisplay->setText("Word not found or network error: " + reply->errorString());
-        statusLabel->setText("Error");
-        pronounceButton->setEnabled(false);
+    // A newer lookup supersedes the one still in flight, and any render of
+    // an earlier reply that has not reached the screen yet
+    if (!concurrentLookups) {
+        dictionaryLookup->cancel(currentRequestId);
+        pendingWords.remove(currentRequestId);
+        currentRequestId = 0;
+        cacheRevalidator->setForegroundActive(!pendingWords.isEmpty());
+        entryRenderer->discardPending();
+        pendingStores.clear();
     }
-    reply->deleteLater();
 }
 
-void MainWindow::parseDictionaryResponse(const QByteArray &data)
+QString MainWindow::statsSummary() const
 {
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (!doc.isArray() || doc.array().isEmpty()) {
-        resultDisplay->setText("Word not found in dictionary.");
-        statusLabel->setText("Not found");
-        pronounceButton->setEnabled(false);
+    QString hedges = QString("Hedges fired %1, won by the hedged backend %2")
+            .arg(dictionaryLookup->hedgesFired()).arg(dictionaryLookup->hedgeWins());
+    return lemmatizer.statsSummary() + "\n" + negativeCache.statsSummary() + "\n" + hedges
+            + "\n" + cacheRevalidator->statsSummary();
+}
+
+void MainWindow::onLookupFinished(const DictionaryResult &result)
+{
+    if (!pendingWords.contains(result.requestId)
+            || (!concurrentLookups && result.requestId != currentRequestId)) {
+        pendingWords.remove(result.requestId);
+        cacheRevalidator->setForegroundActive(!pendingWords.isEmpty());
         return;
     }
 
-    QJsonObject firstEntry = doc.array().first().toObject();
-    QString word = firstEntry["word"].toString();
-
-    // Get phonetic information
-    QString phoneticText = getPhoneticText(firstEntry);
-    currentAudioUrl = getAudioUrl(firstEntry);
-
-    // Format for display (HTML)
-    QString result;
-    result += QString("<h2 style='color: red;'>%1</h2>").arg(word);
-
-    // Add pronunciation
-//    if (!phoneticText.isEmpty()) {
-//        result += QString("<p style='color: #666; font-size: 14px; margin-bottom: 10px;'>");
-//        result += QString("<b>Pronunciation:</b> %1").arg(phoneticText);
-//        result += " 🔊";
-//        result += "</p>";
-//    }
+    QString word = pendingWords.take(result.requestId);
+    QString surface = Lemmatizer::normalize(word);
+    QString lemma = lemmatizer.lemma(word);
+    cacheRevalidator->setForegroundActive(!pendingWords.isEmpty());
+
+    // The API only knows some inflections; retry a 404 with the lemma
+    if (!result.ok && result.httpStatus == 404 && lemma != result.word.toLower()) {
+        statusLabel->setText(QString("\"%1\" not found, trying \"%2\"...").arg(result.word, lemma));
+        quint64 retryId = dictionaryLookup->lookup(lemma);
+        pendingWords.insert(retryId, word);
+        cacheRevalidator->setForegroundActive(true);
+        if (result.requestId == currentRequestId) {
+            currentRequestId = retryId;
+        }
+        return;
+    }
 
-    QJsonArray meanings = firstEntry["meanings"].toArray();
+    lookupProgressBar->setVisible(false);
 
-    for (const QJsonValue &meaningValue : meanings) {
-        QJsonObject meaning = meaningValue.toObject();
-        QString partOfSpeech = meaning["partOfSpeech"].toString();
+    if (result.ok) {
+        CachedResponse entry;
+        entry.queryWord = result.word;
+        entry.data = result.data;
+        entry.etag = result.etag;
+        entry.lastModified = result.lastModified;
+        entry.backend = result.backend;
 
-        QString posColor = "#2E86AB"; // Different color for each part of speech
-        if (partOfSpeech == "noun") posColor = "#A23B72";
-        else if (partOfSpeech == "verb") posColor = "#F18F01";
-        else if (partOfSpeech == "adjective") posColor = "#C73E1D";
-        else if (partOfSpeech == "adverb") posColor = "#3E8914";
-        else if (partOfSpeech == "preposition") posColor = "#8B1E3F";
+        // Cached once the renderer has found an entry in it
+        pendingStores.insert(startRender(word, result.data, false), entry);
+        return;
+    }
 
-        result += QString("<h3 style='color: %1; background-color: #f0f0f0; padding: 5px;'>[%2]</h3>")
-                     .arg(posColor, partOfSpeech.toUpper());
+    // Only a definite "not found" from the API is remembered: not network or
+    // server errors, and not a local dictionary file that lacks the word
+    if (result.httpStatus == 404 && dictionaryLookup->isAuthoritative(result.backend)) {
+        negativeCache.insert(surface);
+    }
+    statusLabel->setToolTip(statsSummary());
 
-        QJsonArray definitions = meaning["definitions"].toArray();
-        for (int i = 0; i < definitions.size() && i < 5; ++i) {
-            QJsonObject definition = definitions[i].toObject();
-            QString def = definition["definition"].toString();
-            result += QString("<p><b>%1.</b> %2").arg(i + 1).arg(def);
+    resultDisplay->setText("Word not found or network error: " + result.errorString);
+    statusLabel->setText("Error");
+    pronounceButton->setEnabled(false);
 
-            if (definition.contains("example")) {
-                QString example = definition["example"].toString();
-                result += QString("<br><i>Example: %1</i>").arg(example);
-            }
+    emit lookupCompleted(word, false);
+}
 
-            // Add synonyms if available
-            if (definition.contains("synonyms")) {
-                QJsonArray synonyms = definition["synonyms"].toArray();
-                if (!synonyms.isEmpty()) {
-                    QStringList synonymList;
-                    for (const QJsonValue &synonym : synonyms) {
-                        synonymList.append(synonym.toString());
-                    }
-                    result += QString("<br><span style='color: #666;'><b>Synonyms:</b> %1</span>")
-                                 .arg(synonymList.join(", "));
-                }
-            }
+quint64 MainWindow::startRender(const QString &word, const QByteArray &data, bool fromCache)
+{
+    // Like the lookups, a newer render supersedes the ones still running
+    if (!concurrentLookups) {
+        entryRenderer->discardPending();
+        pendingStores.clear();
+    }
+    return entryRenderer->render(word, data, fromCache);
+}
 
-            result += "</p>";
+void MainWindow::onEntryRendered(const RenderedEntry &entry)
+{
+    bool fetched = pendingStores.contains(entry.ticket);
+    CachedResponse reply = pendingStores.take(entry.ticket);
+    QString surface = Lemmatizer::normalize(entry.queryWord);
+
+    if (!entry.found) {
+        // An empty entry list from the API is a miss as well; a body that
+        // did not parse is an error page and says nothing about the word
+        if (fetched && entry.valid && dictionaryLookup->isAuthoritative(reply.backend)) {
+            negativeCache.insert(surface);
         }
+        statusLabel->setToolTip(statsSummary());
+        resultDisplay->setText(entry.valid ? "Word not found in dictionary."
+                                           : "Unexpected reply from the dictionary server.");
+        statusLabel->setText(entry.valid ? "Not found" : "Error");
+        pronounceButton->setEnabled(false);
+        emit lookupCompleted(entry.queryWord, false);
+        return;
     }
 
-    // Generate markdown format
-    currentMarkdown = formatMarkdown(firstEntry);
-    currentDefinition = result;
+    if (fetched) {
+        // The reply belongs to the word that was sent. After a lemma retry it
+        // also answers the typed form, which the API does not know; an alias
+        // keeps the export and the revalidator from seeing it twice.
+        QString key = Lemmatizer::normalize(reply.queryWord);
+        negativeCache.remove(surface);
+        responseCache.store(key, reply);
+        responseCache.addAlias(surface, key);
+        statusLabel->setToolTip(statsSummary());
+    }
+
+    for (const QPair<QString, QStringList> &list : entry.synonyms) {
+        synonymGraph.addSynonyms(list.first, list.second);
+    }
 
-    resultDisplay->setHtml(result);
+    currentAudioUrl = entry.audioUrl;
+    currentMarkdown = entry.markdown;
+    currentDefinition = entry.html;
+    QString result = entry.html;
+
+    // Related words come from local data only and are not saved to history
+    QString relatedHtml;
+    QStringList relatedWords = synonymGraph.related(entry.headword);
+    if (!relatedWords.isEmpty()) {
+        relatedHtml = QString("<p style='color: #666;'><b>Related:</b> %1</p>")
+                         .arg(EntryFormatter::wordLinks(relatedWords));
+    }
+    resultDisplay->setHtml(result + relatedHtml);
 
     // Enable pronounce button
     pronounceButton->setEnabled(true);
-    statusLabel->setText("Found - " + QDateTime::currentDateTime().toString("hh:mm:ss"));
+    statusLabel->setText(QString(entry.fromCache ? "Found (cached) - " : "Found - ")
+                         + QDateTime::currentDateTime().toString("hh:mm:ss"));
 
     // Save to history
-    saveWordToHistory(word, result);
-    refreshHistoryList();
+    saveWordToHistory(entry.headword, entry.html, entry.shortDefinition);
 
     // Auto-copy to clipboard
-    copyToClipboard();
-}
-
-QString MainWindow::getPhoneticText(const QJsonObject &entry)
-{
-    // Try to get phonetic text
-    if (entry.contains("phonetic")) {
-        QString phonetic = entry["phonetic"].toString();
-        if (!phonetic.isEmpty()) {
-            return phonetic;
-        }
+    if (!unattended) {
+        copyToClipboard();
     }
 
-    // If no main phonetic, try to get from phonetics array
-    if (entry.contains("phonetics")) {
-        QJsonArray phonetics = entry["phonetics"].toArray();
-        for (const QJsonValue &phoneticValue : phonetics) {
-            QJsonObject phonetic = phoneticValue.toObject();
-            if (phonetic.contains("text")) {
-                QString text = phonetic["text"].toString();
-                if (!text.isEmpty()) {
-                    return text;
-                }
-            }
-        }
+    // Auto-play audio if checkbox is checked
+    if (autoPlayCheckbox->isChecked()) {
+        downloadAndPlayAudio(entry.queryWord, "en");
     }
 
-    return "";
-}
-
-QString MainWindow::getAudioUrl(const QJsonObject &entry)
-{
-    if (entry.contains("phonetics")) {
-        QJsonArray phonetics = entry["phonetics"].toArray();
-        for (const QJsonValue &phoneticValue : phonetics) {
-            QJsonObject phonetic = phoneticValue.toObject();
-            if (phonetic.contains("audio") && !phonetic["audio"].toString().isEmpty()) {
-                QString audioUrl = phonetic["audio"].toString();
-                if (audioUrl.startsWith("http")) {
-                    return audioUrl;
-                }
-            }
-        }
-    }
-    return "";
+    emit lookupCompleted(entry.queryWord, true);
 }
 
 void MainWindow::onPlayPronunciation()
@@ -366,55 +539,59 @@ void MainWindow::downloadAndPlayAudio(const QString &text, const QString &langua
     if (text.isEmpty()) return;
 
     // Check if audio file already exists locally
-    QString safeWord = text;
-    safeWord.replace(QRegularExpression("[^a-zA-Z0-9]"), "_");
-    QString localAudioFile = QString("word_audio/%1_%2.mp3").arg(safeWord).arg(language);
+    QString localAudioFile = audioFilePath(text, language);
 
     QFile file(localAudioFile);
     if (file.exists()) {
         // Play local audio file using Qt Multimedia
         playAudioFile(localAudioFile);
+        emit pronunciationCompleted(text, true);
         return;
     }
 
     statusLabel->setText("Downloading audio pronunciation...");
     audioProgressBar->setVisible(true);
 
-    // Encode text for URL
-    QString encodedText = QUrl::toPercentEncoding(text);
+    // Encode text for URL; the typed word is spoken, never its stem
+    QString encodedText = QUrl::toPercentEncoding(text.trimmed());
 
-    // Construct Google TTS URL
-    QString url = QString("https://translate.google.com/translate_tts?ie=UTF-8&tl=%1&client=tw-ob&q=%2")
-                     .arg(language).arg(encodedText);
+    // Construct TTS URL (Google TTS unless overridden in the settings)
+    QString url = ttsUrlTemplate.arg(language, encodedText);
 
     // Set headers to mimic a real browser
     QNetworkRequest request(url);
     request.setRawHeader("User-Agent", "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/91.0.4472.124 Safari/537.36");
     request.setRawHeader("Referer", "https://translate.google.com/");
 
-    // Download the audio
-    ttsNetworkManager->get(request);
+    // Download the audio; the reply remembers its word so overlapping downloads save correctly
+    QNetworkReply *reply = ttsNetworkManager->get(request);
+    reply->setProperty("word", text);
+    reply->setProperty("language", language);
 }
 
 void MainWindow::onTtsReply(QNetworkReply *reply)
 {
     audioProgressBar->setVisible(false);
 
+    QString word = reply->property("word").toString();
+    bool ok = false;
+
     if (reply->error() == QNetworkReply::NoError) {
         QByteArray audioData = reply->readAll();
 
         // Save to word_audio folder with filename based on the word
-        QString safeWord = currentWord;
-        safeWord.replace(QRegularExpression("[^a-zA-Z0-9]"), "_");
-        QString localAudioFile = QString("word_audio/%1_en.mp3").arg(safeWord);
+        QString localAudioFile = audioFilePath(word, reply->property("language").toString());
 
-        QFile file(localAudioFile);
-        if (file.open(QIODevice::WriteOnly)) {
-            file.write(audioData);
-            file.close();
+        // Written to a temporary file and renamed into place, so other
+        // instances never play a half-written recording
+        QSaveFile file(localAudioFile);
+        bool saved = file.open(QIODevice::WriteOnly) && file.write(audioData) == audioData.size() && file.commit();
 
+        // The rename can lose to another instance saving the same word; its copy is complete too
+        if (saved || QFile::exists(localAudioFile)) {
             // Play the audio using Qt Multimedia
             playAudioFile(localAudioFile);
+            ok = true;
         } else {
             statusLabel->setText("Error saving audio file");
         }
@@ -422,10 +599,16 @@ void MainWindow::onTtsReply(QNetworkReply *reply)
         statusLabel->setText("Audio download failed: " + reply->errorString());
     }
     reply->deleteLater();
+
+    emit pronunciationCompleted(word, ok);
 }
 
 void MainWindow::playAudioFile(const QString &filePath)
 {
+    if (unattended) {
+        return;
+    }
+
     statusLabel->setText("Playing pronunciation...");
 
     #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -509,63 +692,6 @@ void MainWindow::onPlayerError(QMediaPlayer::Error error, const QString &errorSt
 }
 #endif
 
-QString MainWindow::formatMarkdown(const QJsonObject &entry)
-{
-    QString markdown;
-    QString word = entry["word"].toString();
-    QString phoneticText = getPhoneticText(entry);
-
-    // Word in red (using HTML color for markdown compatibility)
-    markdown += QString("# <font color='red'>%1</font>\n\n").arg(word);
-
-    // Add pronunciation
-//    if (!phoneticText.isEmpty()) {
-//        markdown += QString("**Pronunciation:** %1").arg(phoneticText);
-//        markdown += " 🔊";
-//        markdown += "\n\n";
-//    }
-
-    QJsonArray meanings = entry["meanings"].toArray();
-
-    for (const QJsonValue &meaningValue : meanings) {
-        QJsonObject meaning = meaningValue.toObject();
-        QString partOfSpeech = meaning["partOfSpeech"].toString();
-
-        // Part of speech in brackets
-        markdown += QString("**[%1]**\n\n").arg(partOfSpeech.toUpper());
-
-        QJsonArray definitions = meaning["definitions"].toArray();
-        for (int i = 0; i < definitions.size() && i < 5; ++i) {
-            QJsonObject definition = definitions[i].toObject();
-            QString def = definition["definition"].toString();
-
-            // Numbered definitions on new lines
-            markdown += QString("%1. %2").arg(i + 1).arg(def);
-
-            if (definition.contains("example")) {
-                QString example = definition["example"].toString();
-                markdown += QString("\n   *Example: %1*").arg(example);
-            }
-
-            // Add synonyms if available
-            if (definition.contains("synonyms")) {
-                QJsonArray synonyms = definition["synonyms"].toArray();
-                if (!synonyms.isEmpty()) {
-                    QStringList synonymList;
-                    for (const QJsonValue &synonym : synonyms) {
-                        synonymList.append(synonym.toString());
-                    }
-                    markdown += QString("\n   *Synonyms: %1*").arg(synonymList.join(", "));
-                }
-            }
-
-            markdown += "\n\n";
-        }
-    }
-
-    return markdown;
-}
-
 void MainWindow::copyToClipboard()
 {
     if (!currentMarkdown.isEmpty()) {
@@ -576,85 +702,108 @@ void MainWindow::copyToClipboard()
 
 void MainWindow::copyHistoryToClipboard()
 {
-    QString historyText = historyDetailDisplay->toPlainText();
-    if (!historyText.isEmpty()) {
-        QString markdown = "# History Lookup\n\n";
-
-        QListWidgetItem *currentItem = historyList->currentItem();
-        if (currentItem) {
-            QString itemText = currentItem->text();
-            QStringList parts = itemText.split(" - ");
-            if (parts.size() >= 2) {
-                QString wordPart = parts[1];
-                QString word = wordPart.split(":")[0].trimmed();
-                markdown += QString("## <font color='red'>%1</font>\n\n").arg(word);
-            }
-        }
-
-        QString plainText = historyText;
-        plainText.replace(QRegularExpression("\\[[A-Z]+\\]"), "**$0**"); // Bold the [NOUN], [VERB] etc.
-        plainText.replace(QRegularExpression("^(\\d+\\.)"), "**$1**"); // Bold the numbers
-        markdown += plainText;
+    QListWidgetItem *currentItem = historyList->currentItem();
+    if (currentItem && !historyDetailDisplay->toPlainText().isEmpty()) {
+        // Same renderer as the bulk export, fed from the stored HTML
+        QString word = currentItem->data(Qt::UserRole + 2).toString();
+        QString fullDefinition = currentItem->data(Qt::UserRole + 1).toString();
+        QString markdown = "# History Lookup\n\n" + EntryFormatter::historyMarkdown(word, fullDefinition);
 
         QApplication::clipboard()->setText(markdown);
         statusLabel->setText("History markdown copied to clipboard - " + QDateTime::currentDateTime().toString("hh:mm:ss"));
     }
 }
 
-void MainWindow::saveWordToHistory(const QString &word, const QString &definition)
+void MainWindow::exportHistory()
 {
-    QFile file(historyFile);
-    if (file.open(QIODevice::Append | QIODevice::Text)) {
-        QTextStream stream(&file);
-        QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
+    startExport(false);
+}
 
-        QString shortDefinition = definition;
-        shortDefinition.remove(QRegularExpression("<[^>]*>"));
-        shortDefinition.replace("&nbsp;", " ");
-        shortDefinition = shortDefinition.left(100);
+void MainWindow::exportCache()
+{
+    startExport(true);
+}
 
-        stream << timestamp << "|" << word << "|" << definition << "|" << shortDefinition << "\n";
-        file.close();
+void MainWindow::startExport(bool fromCache)
+{
+    QString outputFile = QFileDialog::getSaveFileName(this, fromCache ? "Export Cache" : "Export History",
+                                                      fromCache ? "dictionary_cache.md" : "dictionary_history.md",
+                                                      "Markdown (*.md);;CSV (*.csv);;Anki deck (*.txt)");
+    if (outputFile.isEmpty()) {
+        return;
     }
+
+    HistoryExporter::Format format = HistoryExporter::formatForFileName(outputFile);
+    statusLabel->setText("Exporting to " + outputFile + "...");
+    exportButton->setEnabled(false);
+
+    // The export renders on the thread pool; the cache is handed over as an implicitly shared copy
+    QFutureWatcher<ExportResult> *watcher = new QFutureWatcher<ExportResult>(this);
+    connect(watcher, &QFutureWatcher<ExportResult>::finished, this, [this, watcher, outputFile]() {
+        ExportResult result = watcher->result();
+        if (result.ok) {
+            statusLabel->setText(QString("Exported %1 entries to %2 in %3 ms")
+                                 .arg(result.entries).arg(outputFile).arg(result.elapsedMs));
+        } else {
+            statusLabel->setText("Export failed: " + result.errorString);
+        }
+        exportButton->setEnabled(true);
+        watcher->deleteLater();
+    });
+
+    if (fromCache) {
+        QHash<QString, QByteArray> cache = responseCache.bodies();
+        watcher->setFuture(QtConcurrent::run([cache, outputFile, format]() {
+            return HistoryExporter::exportCache(cache, outputFile, format);
+        }));
+    } else {
+        QString history = historyFile;
+        watcher->setFuture(QtConcurrent::run([history, outputFile, format]() {
+            return HistoryExporter::exportHistory(history, outputFile, format);
+        }));
+    }
+}
+
+void MainWindow::saveWordToHistory(const QString &word, const QString &definition, const QString &shortDefinition)
+{
+    HistoryEntry entry;
+    entry.timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
+    entry.word = word;
+    entry.fullDefinition = definition;
+    entry.shortDefinition = shortDefinition;
+
+    // The list is updated through entriesAdded, like for other instances' lines
+    historyStore->append(entry);
 }
 
 void MainWindow::loadHistory()
 {
-    refreshHistoryList();
+    historyStore->reload();
 }
 
-void MainWindow::refreshHistoryList()
+void MainWindow::onHistoryReset()
 {
     historyList->clear();
     historyDetailDisplay->clear();
+}
 
-    QFile file(historyFile);
-    if (file.exists() && file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream stream(&file);
-        QStringList lines;
-
-        while (!stream.atEnd()) {
-            lines.prepend(stream.readLine());
-        }
-
-        for (const QString &line : lines) {
-            QStringList parts = line.split("|");
-            if (parts.size() >= 4) {
-                QString timestamp = parts[0];
-                QString word = parts[1];
-                QString fullDefinition = parts[2];
-                QString shortDefinition = parts[3];
+void MainWindow::onHistoryEntriesAdded(const QVector<HistoryEntry> &entries)
+{
+    // Newest first
+    for (const HistoryEntry &entry : entries) {
+        historyList->insertItem(0, historyItem(entry));
+    }
+}
 
-                QString displayText = QString("%1 - %2: %3").arg(timestamp, word, shortDefinition);
+QListWidgetItem *MainWindow::historyItem(const HistoryEntry &entry) const
+{
+    QString displayText = QString("%1 - %2: %3").arg(entry.timestamp, entry.word, entry.shortDefinition);
 
-                QListWidgetItem *item = new QListWidgetItem(displayText);
-                item->setData(Qt::UserRole, word);
-                item->setData(Qt::UserRole + 1, fullDefinition);
-                historyList->addItem(item);
-            }
-        }
-        file.close();
-    }
+    QListWidgetItem *item = new QListWidgetItem(displayText);
+    item->setData(Qt::UserRole, Lemmatizer::normalize(entry.word));
+    item->setData(Qt::UserRole + 1, entry.fullDefinition);
+    item->setData(Qt::UserRole + 2, entry.word);
+    return item;
 }
 
 void MainWindow::onHistoryItemClicked(QListWidgetItem *item)
@@ -675,12 +824,21 @@ void MainWindow::onHistoryItemClicked(QListWidgetItem *item)
     }
 }
 
+void MainWindow::onWordLinkClicked(const QUrl &url)
+{
+    if (url.scheme() != "word") {
+        return;
+    }
+
+    // Synonym links open like a typed lookup; known words come from the cache
+    wordInput->setText(url.path());
+    onLookupWord();
+}
+
 void MainWindow::playAudioForWord(const QString &word)
 {
     // Check if audio file exists locally in word_audio folder
-    QString safeWord = word;
-    safeWord.replace(QRegularExpression("[^a-zA-Z0-9]"), "_");
-    QString localAudioFile = QString("word_audio/%1_en.mp3").arg(safeWord);
+    QString localAudioFile = audioFilePath(word);
 
     QFile file(localAudioFile);
     if (file.exists()) {
@@ -694,6 +852,14 @@ void MainWindow::playAudioForWord(const QString &word)
     }
 }
 
+QString MainWindow::audioFilePath(const QString &word, const QString &language) const
+{
+    // One recording per spelling: "ran" and "run" are pronounced differently
+    QString safeWord = Lemmatizer::normalize(word);
+    safeWord.replace(QRegularExpression("[^a-zA-Z0-9]"), "_");
+    return QString("%1/%2_%3.mp3").arg(audioDirectory, safeWord, language);
+}
+
 bool MainWindow::event(QEvent *event)
 {
     if (event->type() == QEvent::WindowActivate) {
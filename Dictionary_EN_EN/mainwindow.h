@@ -7,6 +7,7 @@
 #include <QSplitter>
 #include <QLineEdit>
 #include <QTextEdit>
+#include <QTextBrowser>
 #include <QPushButton>
 #include <QLabel>
 #include <QListWidget>
@@ -14,6 +15,14 @@
 #include <QMediaPlayer>
 #include <QCheckBox>
 #include <QProgressBar>
+#include "hedgedlookup.h"
+#include "lemmatizer.h"
+#include "synonymgraph.h"
+#include "responsecache.h"
+#include "negativecache.h"
+#include "cacherevalidator.h"
+#include "entryrenderer.h"
+#include "historystore.h"
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
 #include <QAudioOutput>
@@ -24,21 +33,43 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    MainWindow(QWidget *parent = nullptr, const QString &settingsPath = "dictionary_settings.ini");
     ~MainWindow();
 
+    // Same paths as typing a word / pressing the pronounce button; used by the load test
+    void lookupWord(const QString &word);
+    void pronounceWord(const QString &word);
+
+    // Keep overlapping lookups instead of letting a new one supersede the last
+    void setConcurrentLookups(bool enabled) { concurrentLookups = enabled; }
+    // No audio playback and no clipboard writes, for runs nobody is watching
+    void setUnattended(bool enabled) { unattended = enabled; }
+
+    // Lemma cache, negative cache and hedging counters, one per line
+    QString statsSummary() const;
+
+signals:
+    void lookupCompleted(const QString &word, bool ok);
+    void pronunciationCompleted(const QString &word, bool ok);
+
 protected:
     bool event(QEvent *event) override;
     void showEvent(QShowEvent *event) override;
 
 private slots:
     void onLookupWord();
-    void onNetworkReply(QNetworkReply *reply);
+    void onLookupFinished(const DictionaryResult &result);
+    void onEntryRendered(const RenderedEntry &entry);
+    void onHistoryReset();
+    void onHistoryEntriesAdded(const QVector<HistoryEntry> &entries);
     void onTtsReply(QNetworkReply *reply);
     void onPlayPronunciation();
     void onHistoryItemClicked(QListWidgetItem *item);
+    void onWordLinkClicked(const QUrl &url);
     void copyToClipboard();
     void copyHistoryToClipboard();
+    void exportHistory();
+    void exportCache();
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
     void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
@@ -49,17 +80,19 @@ private slots:
 #endif
 
 private:
+    void loadSettings();
     void setupUI();
+    void setupBackends();
     void downloadAndPlayAudio(const QString &text, const QString &language = "en");
     void playAudioFile(const QString &filePath);
     void playAudioForWord(const QString &word);
-    void parseDictionaryResponse(const QByteArray &data);
-    QString formatMarkdown(const QJsonObject &entry);
-    QString getPhoneticText(const QJsonObject &entry);
-    QString getAudioUrl(const QJsonObject &entry);
-    void saveWordToHistory(const QString &word, const QString &definition);
+    QString audioFilePath(const QString &word, const QString &language = "en") const;
+    void cancelCurrentLookup();
+    quint64 startRender(const QString &word, const QByteArray &data, bool fromCache);
+    void saveWordToHistory(const QString &word, const QString &definition, const QString &shortDefinition);
     void loadHistory();
-    void refreshHistoryList();
+    QListWidgetItem *historyItem(const HistoryEntry &entry) const;
+    void startExport(bool fromCache);
 
     // UI Components
     QSplitter *mainSplitter;
@@ -68,18 +101,28 @@ private:
     QCheckBox *autoPlayCheckbox;
     QProgressBar *lookupProgressBar;
     QProgressBar *audioProgressBar;
-    QTextEdit *resultDisplay;
-    QTextEdit *historyDetailDisplay;
+    QTextBrowser *resultDisplay;
+    QTextBrowser *historyDetailDisplay;
     QListWidget *historyList;
     QPushButton *lookupButton;
     QPushButton *copyButton;
     QPushButton *copyHistoryButton;
+    QPushButton *exportButton;
     QLabel *statusLabel;
 
     // Network
-    QNetworkAccessManager *networkManager;
+    HedgedLookup *dictionaryLookup;
+    quint64 currentRequestId;
+    QHash<quint64, QString> pendingWords;
+    bool concurrentLookups;
+    bool unattended;
+    QString ttsUrlTemplate;
     QNetworkAccessManager *ttsNetworkManager;
 
+    // Replies are parsed and formatted off the GUI thread
+    EntryRenderer *entryRenderer;
+    QHash<quint64, CachedResponse> pendingStores;  // Render ticket -> reply to cache once it holds an entry
+
     // Media
     QMediaPlayer *mediaPlayer;
     #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -88,10 +131,27 @@ private:
 
     // Data
     QString historyFile;
+    HistoryStore *historyStore;
+    QString settingsFile;
+    QString audioDirectory;
     QString currentWord;
     QString currentMarkdown;
     QString currentDefinition;
     QString currentAudioUrl;
+
+    // Lookup keys are normalized to lemmas so inflected forms share entries
+    Lemmatizer lemmatizer;
+    ResponseCache responseCache;
+    CacheRevalidator *cacheRevalidator;
+    QString responseCacheFile;
+
+    // Words the API does not know, so typos are not requested again
+    NegativeCache negativeCache;
+    QString negativeCacheFile;
+
+    // Synonyms of every entry seen, for link navigation and suggestions
+    SynonymGraph synonymGraph;
+    QString synonymGraphFile;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,250 @@
+#include "mockdictionaryserver.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+
+MockDictionaryServer::MockDictionaryServer(QObject *parent)
+    : QObject(parent)
+    , server(new QTcpServer(this))
+    , ttsRecording(QByteArray(1024, '\0'))
+    , baseLatencyMs(0)
+    , latencyJitterMs(0)
+    , errorRate(0.0)
+    , rateLimit(0)
+    , synthesizeMissing(true)
+    , rateWindowCount(0)
+    , servedCount(0)
+    , errorCount(0)
+    , rateLimitedCount(0)
+{
+    connect(server, &QTcpServer::newConnection, this, &MockDictionaryServer::onNewConnection);
+    rateWindow.start();
+}
+
+bool MockDictionaryServer::listen(quint16 port)
+{
+    return server->listen(QHostAddress::LocalHost, port);
+}
+
+quint16 MockDictionaryServer::port() const
+{
+    return server->serverPort();
+}
+
+QString MockDictionaryServer::dictionaryUrlTemplate() const
+{
+    return QString("http://127.0.0.1:%1/api/v2/entries/en/%2").arg(port()).arg("%1");
+}
+
+QString MockDictionaryServer::ttsUrlTemplate() const
+{
+    return QString("http://127.0.0.1:%1/translate_tts?ie=UTF-8&tl=%2&client=tw-ob&q=%3").arg(port()).arg("%1", "%2");
+}
+
+int MockDictionaryServer::loadRecordings(const QString &directory)
+{
+    QDir dir(directory);
+    const QFileInfoList files = dir.entryInfoList(QStringList() << "*.json" << "tts.mp3", QDir::Files);
+    for (const QFileInfo &info : files) {
+        QFile file(info.filePath());
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        if (info.fileName() == "tts.mp3") {
+            ttsRecording = file.readAll();
+        } else {
+            recordings.insert(info.completeBaseName().toLower(), file.readAll());
+        }
+    }
+    return recordings.size();
+}
+
+void MockDictionaryServer::setLatency(int baseMs, int jitterMs)
+{
+    baseLatencyMs = qMax(0, baseMs);
+    latencyJitterMs = qMax(0, jitterMs);
+}
+
+void MockDictionaryServer::setErrorRate(double rate)
+{
+    errorRate = qBound(0.0, rate, 1.0);
+}
+
+void MockDictionaryServer::setRateLimit(int requestsPerSecond)
+{
+    rateLimit = qMax(0, requestsPerSecond);
+}
+
+void MockDictionaryServer::onNewConnection()
+{
+    while (QTcpSocket *socket = server->nextPendingConnection()) {
+        readBuffers.insert(socket, QByteArray());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            onReadyRead(socket);
+        });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            readBuffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MockDictionaryServer::onReadyRead(QTcpSocket *socket)
+{
+    QByteArray &buffer = readBuffers[socket];
+    buffer += socket->readAll();
+
+    // One request at a time per connection keeps keep-alive replies in order
+    if (socket->property("busy").toBool()) {
+        return;
+    }
+
+    int headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        return;
+    }
+
+    QByteArray requestLine = buffer.left(buffer.indexOf("\r\n"));
+    buffer.remove(0, headerEnd + 4);
+
+    QList<QByteArray> parts = requestLine.split(' ');
+    if (parts.size() < 2) {
+        sendResponse(socket, 400, "text/plain", "Bad Request");
+        return;
+    }
+
+    socket->setProperty("busy", true);
+    int delay = baseLatencyMs;
+    if (latencyJitterMs > 0) {
+        delay += QRandomGenerator::global()->bounded(latencyJitterMs + 1);
+    }
+
+    QByteArray method = parts[0];
+    QByteArray target = parts[1];
+    QTimer::singleShot(delay, socket, [this, socket, method, target]() {
+        handleRequest(socket, method, target);
+        socket->setProperty("busy", false);
+        if (readBuffers.value(socket).contains("\r\n\r\n")) {
+            onReadyRead(socket);
+        }
+    });
+}
+
+void MockDictionaryServer::handleRequest(QTcpSocket *socket, const QByteArray &method, const QByteArray &target)
+{
+    if (isRateLimited()) {
+        rateLimitedCount++;
+        sendResponse(socket, 429, "application/json", "{\"title\":\"Too Many Requests\"}");
+        return;
+    }
+
+    if (errorRate > 0.0 && QRandomGenerator::global()->generateDouble() < errorRate) {
+        errorCount++;
+        sendResponse(socket, 500, "application/json", "{\"title\":\"Internal Server Error\"}");
+        return;
+    }
+
+    if (method != "GET") {
+        sendResponse(socket, 405, "text/plain", "Method Not Allowed");
+        return;
+    }
+
+    QUrl url(QString::fromUtf8("http://localhost" + target));
+    QString path = url.path();
+
+    if (path.startsWith("/translate_tts")) {
+        sendResponse(socket, 200, "audio/mpeg", ttsRecording);
+        return;
+    }
+
+    const QString dictionaryPrefix = "/api/v2/entries/en/";
+    if (path.startsWith(dictionaryPrefix)) {
+        int status = 200;
+        QByteArray body = dictionaryReply(path.mid(dictionaryPrefix.size()), &status);
+        sendResponse(socket, status, "application/json", body);
+        return;
+    }
+
+    sendResponse(socket, 404, "text/plain", "Not Found");
+}
+
+QByteArray MockDictionaryServer::dictionaryReply(const QString &word, int *status) const
+{
+    auto it = recordings.constFind(word.toLower());
+    if (it != recordings.constEnd()) {
+        *status = 200;
+        return it.value();
+    }
+
+    if (!synthesizeMissing) {
+        *status = 404;
+        return "{\"title\":\"No Definitions Found\"}";
+    }
+
+    // Same shape as a real dictionaryapi.dev entry
+    QJsonObject definition;
+    definition["definition"] = QString("Synthetic definition of %1 served by the mock server.").arg(word);
+    definition["example"] = QString("An example sentence using %1.").arg(word);
+    definition["synonyms"] = QJsonArray();
+
+    QJsonObject meaning;
+    meaning["partOfSpeech"] = "noun";
+    meaning["definitions"] = QJsonArray() << definition;
+    meaning["synonyms"] = QJsonArray();
+
+    QJsonObject entry;
+    entry["word"] = word;
+    entry["phonetics"] = QJsonArray();
+    entry["meanings"] = QJsonArray() << meaning;
+
+    *status = 200;
+    return QJsonDocument(QJsonArray() << entry).toJson(QJsonDocument::Compact);
+}
+
+void MockDictionaryServer::sendResponse(QTcpSocket *socket, int status, const QByteArray &contentType, const QByteArray &body)
+{
+    QByteArray reason = "OK";
+    switch (status) {
+    case 400: reason = "Bad Request"; break;
+    case 404: reason = "Not Found"; break;
+    case 405: reason = "Method Not Allowed"; break;
+    case 429: reason = "Too Many Requests"; break;
+    case 500: reason = "Internal Server Error"; break;
+    default: break;
+    }
+
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + " " + reason + "\r\n";
+    response += "Content-Type: " + contentType + "\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    if (status == 429) {
+        response += "Retry-After: 1\r\n";
+    }
+    response += "Connection: keep-alive\r\n\r\n";
+    response += body;
+
+    socket->write(response);
+    servedCount++;
+}
+
+bool MockDictionaryServer::isRateLimited()
+{
+    if (rateLimit <= 0) {
+        return false;
+    }
+
+    // Fixed one-second window
+    if (rateWindow.elapsed() >= 1000) {
+        rateWindow.restart();
+        rateWindowCount = 0;
+    }
+    return ++rateWindowCount > rateLimit;
+}
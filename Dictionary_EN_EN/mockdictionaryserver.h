@@ -0,0 +1,70 @@
+#ifndef MOCKDICTIONARYSERVER_H
+#define MOCKDICTIONARYSERVER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+
+class QTcpServer;
+class QTcpSocket;
+
+// Minimal local HTTP/1.1 stand-in for dictionaryapi.dev and the Google TTS
+// endpoint, used by the load test. Replays recorded responses (or a
+// synthesized entry for unknown words) with injectable latency, 500 errors
+// and 429 rate limiting.
+class MockDictionaryServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MockDictionaryServer(QObject *parent = nullptr);
+
+    bool listen(quint16 port = 0);
+    quint16 port() const;
+
+    // Endpoint templates in the format the app settings expect
+    QString dictionaryUrlTemplate() const;
+    QString ttsUrlTemplate() const;
+
+    // <word>.json files hold dictionary replies, tts.mp3 the audio reply
+    int loadRecordings(const QString &directory);
+
+    void setLatency(int baseMs, int jitterMs);
+    void setErrorRate(double rate);
+    void setRateLimit(int requestsPerSecond);
+    void setSynthesizeMissing(bool enabled) { synthesizeMissing = enabled; }
+
+    int requestsServed() const { return servedCount; }
+    int errorsInjected() const { return errorCount; }
+    int requestsRateLimited() const { return rateLimitedCount; }
+
+private:
+    void onNewConnection();
+    void onReadyRead(QTcpSocket *socket);
+    void handleRequest(QTcpSocket *socket, const QByteArray &method, const QByteArray &target);
+    void sendResponse(QTcpSocket *socket, int status, const QByteArray &contentType, const QByteArray &body);
+    QByteArray dictionaryReply(const QString &word, int *status) const;
+    bool isRateLimited();
+
+    QTcpServer *server;
+    QHash<QTcpSocket *, QByteArray> readBuffers;
+    QHash<QString, QByteArray> recordings;
+    QByteArray ttsRecording;
+
+    int baseLatencyMs;
+    int latencyJitterMs;
+    double errorRate;
+    int rateLimit;
+    bool synthesizeMissing;
+
+    QElapsedTimer rateWindow;
+    int rateWindowCount;
+
+    int servedCount;
+    int errorCount;
+    int rateLimitedCount;
+};
+
+#endif // MOCKDICTIONARYSERVER_H
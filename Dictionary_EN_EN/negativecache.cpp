@@ -0,0 +1,328 @@
+#include "negativecache.h"
+#include "sharedjournal.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QLockFile>
+#include <QSaveFile>
+
+namespace {
+const quint32 kNegativeMagic = 0x4e434143; // "NCAC"
+const quint32 kNegativeVersion = 1;
+
+// 10 bits and 7 probes per word give a false-positive rate just under 1%
+const int kBitsPerEntry = 10;
+const int kHashCount = 7;
+const int kMinBits = 8192;
+
+// Journal records
+enum RecordType : quint8 {
+    InsertRecord,
+    RemoveRecord
+};
+
+qint64 now()
+{
+    return QDateTime::currentMSecsSinceEpoch() / 1000;
+}
+
+// FNV-1a over the UTF-16 code units; the second hash is derived from the
+// first for double hashing (h1 + i * h2)
+void bloomHashes(const QString &key, quint64 *h1, quint64 *h2)
+{
+    quint64 hash = 14695981039346656037ULL;
+    const ushort *data = reinterpret_cast<const ushort *>(key.constData());
+    for (int i = 0; i < key.size(); ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    *h1 = hash;
+
+    // splitmix64 finalizer; odd so every probe lands on a different bit
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    *h2 = hash | 1;
+}
+}
+
+NegativeCache::NegativeCache()
+    : hashCount(kHashCount)
+    , ttl(24 * 3600)
+    , savedCount(0)
+    , rejectedCount(0)
+    , falsePositiveCount(0)
+    , journal(nullptr)
+    , modified(false)
+{
+    bloomBits.fill(0, kMinBits / 64);
+}
+
+bool NegativeCache::contains(const QString &key)
+{
+    // Most lookups are for real words and stop here
+    if (!testBloomBits(key)) {
+        rejectedCount++;
+        return false;
+    }
+
+    auto it = misses.constFind(key);
+    if (it == misses.constEnd()) {
+        falsePositiveCount++;
+        return false;
+    }
+    if (isExpired(*it)) {
+        return false;
+    }
+
+    savedCount++;
+    return true;
+}
+
+void NegativeCache::insert(const QString &key)
+{
+    qint64 missedAt = now();
+    insertAt(key, missedAt);
+    modified = true;
+
+    if (journal) {
+        QByteArray record;
+        QDataStream stream(&record, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << quint8(InsertRecord) << key << missedAt;
+        journal->append(record);
+    }
+}
+
+void NegativeCache::insertAt(const QString &key, qint64 missedAt)
+{
+    misses.insert(key, missedAt);
+    removedKeys.remove(key);
+
+    if (qint64(misses.size()) * kBitsPerEntry > qint64(bloomBits.size()) * 64) {
+        rebuild();
+    } else {
+        setBloomBits(key);
+    }
+}
+
+void NegativeCache::remove(const QString &key)
+{
+    // The filter keeps the key's bits until the next rebuild
+    if (misses.remove(key) > 0) {
+        removedKeys.insert(key);
+        modified = true;
+
+        if (journal) {
+            QByteArray record;
+            QDataStream stream(&record, QIODevice::WriteOnly);
+            stream.setVersion(QDataStream::Qt_5_0);
+            stream << quint8(RemoveRecord) << key;
+            journal->append(record);
+        }
+    }
+}
+
+void NegativeCache::attachJournal(SharedJournal *log)
+{
+    journal = log;
+
+    // Dropped with the journal, which emits nothing once the cache may be gone
+    QObject::connect(journal, &SharedJournal::recordsAdded, journal, [this](const QList<QByteArray> &records) {
+        applyRecords(records);
+    });
+    QObject::connect(journal, &SharedJournal::reset, journal, [this]() {
+        merge(journal->snapshotPath());
+    });
+    journal->readNew();
+}
+
+void NegativeCache::applyRecords(const QList<QByteArray> &records)
+{
+    // In log order, so a word missed and then found elsewhere ends up removed
+    for (const QByteArray &record : records) {
+        QDataStream stream(record);
+        stream.setVersion(QDataStream::Qt_5_0);
+
+        quint8 type = 0;
+        QString key;
+        stream >> type >> key;
+        if (stream.status() != QDataStream::Ok) {
+            continue;
+        }
+
+        if (type == InsertRecord) {
+            qint64 missedAt = 0;
+            stream >> missedAt;
+            auto own = misses.constFind(key);
+            if (stream.status() == QDataStream::Ok && (own == misses.constEnd() || *own < missedAt)) {
+                insertAt(key, missedAt);
+            }
+        } else if (type == RemoveRecord) {
+            if (misses.remove(key) > 0) {
+                removedKeys.insert(key);
+            }
+        }
+    }
+}
+
+double NegativeCache::falsePositiveRate() const
+{
+    int negatives = rejectedCount + falsePositiveCount;
+    return negatives > 0 ? double(falsePositiveCount) / negatives : 0.0;
+}
+
+QString NegativeCache::statsSummary() const
+{
+    return QString("Known misses %1, requests saved %2, Bloom false positives %3% (%4 of %5)")
+            .arg(misses.size())
+            .arg(savedCount)
+            .arg(falsePositiveRate() * 100, 0, 'f', 2)
+            .arg(falsePositiveCount)
+            .arg(rejectedCount + falsePositiveCount);
+}
+
+bool NegativeCache::isExpired(qint64 missedAt) const
+{
+    return now() - missedAt >= ttl;
+}
+
+void NegativeCache::setBloomBits(const QString &key)
+{
+    quint64 h1, h2;
+    bloomHashes(key, &h1, &h2);
+    quint64 bitCount = quint64(bloomBits.size()) * 64;
+    for (int i = 0; i < hashCount; ++i) {
+        quint64 bit = (h1 + quint64(i) * h2) % bitCount;
+        bloomBits[int(bit / 64)] |= quint64(1) << (bit % 64);
+    }
+}
+
+bool NegativeCache::testBloomBits(const QString &key) const
+{
+    quint64 h1, h2;
+    bloomHashes(key, &h1, &h2);
+    quint64 bitCount = quint64(bloomBits.size()) * 64;
+    for (int i = 0; i < hashCount; ++i) {
+        quint64 bit = (h1 + quint64(i) * h2) % bitCount;
+        if (!(bloomBits.at(int(bit / 64)) & (quint64(1) << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void NegativeCache::rebuild()
+{
+    for (auto it = misses.begin(); it != misses.end();) {
+        if (isExpired(it.value())) {
+            it = misses.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Room to double before the next rebuild
+    int bits = qMax(kMinBits, misses.size() * kBitsPerEntry * 2);
+    bloomBits.fill(0, (bits + 63) / 64);
+    for (auto it = misses.constBegin(); it != misses.constEnd(); ++it) {
+        setBloomBits(it.key());
+    }
+}
+
+bool NegativeCache::load(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 count = 0;
+    stream >> magic >> version >> count;
+    if (magic != kNegativeMagic || version != kNegativeVersion || count < 0) {
+        return false;
+    }
+
+    QHash<QString, qint64> loaded;
+    loaded.reserve(count);
+    for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString key;
+        qint64 missedAt = 0;
+        stream >> key >> missedAt;
+        loaded.insert(key, missedAt);
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    misses = loaded;
+    removedKeys.clear();
+    rebuild();
+    modified = false;
+    return true;
+}
+
+bool NegativeCache::merge(const QString &filePath)
+{
+    NegativeCache onDisk;
+    onDisk.setTtl(ttl);
+    if (!onDisk.load(filePath)) {
+        return false;
+    }
+
+    for (auto it = onDisk.misses.constBegin(); it != onDisk.misses.constEnd(); ++it) {
+        if (removedKeys.contains(it.key())) {
+            continue;
+        }
+        auto own = misses.constFind(it.key());
+        if (own == misses.constEnd() || *own < it.value()) {
+            misses.insert(it.key(), it.value());
+        }
+    }
+    rebuild();
+    return true;
+}
+
+bool NegativeCache::save(const QString &filePath)
+{
+    // Other instances save the same file; merge under a lock so no one's misses are lost
+    QLockFile lock(filePath + ".lock");
+    if (!lock.tryLock(5000)) {
+        return false;
+    }
+
+    merge(filePath);
+    if (journal) {
+        // The snapshot replaces the log, so it must hold every record in it
+        journal->readNew();
+    }
+    rebuild();
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << kNegativeMagic << kNegativeVersion << qint32(misses.size());
+    for (auto it = misses.constBegin(); it != misses.constEnd(); ++it) {
+        stream << it.key() << it.value();
+    }
+
+    if (!file.commit()) {
+        return false;
+    }
+    if (journal) {
+        journal->truncateLocked();
+    }
+    modified = false;
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef NEGATIVECACHE_H
+#define NEGATIVECACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+class SharedJournal;
+
+// Words the API answered with "not found", persisted between runs so
+// typos are not sent again. A Bloom filter rejects the common case (a word
+// that never missed) without touching the table; words it lets through are
+// confirmed against the exact miss table, whose entries expire after ttl.
+// Like ResponseCache, it can log changes to a journal shared with other
+// instances and apply theirs as they arrive.
+class NegativeCache
+{
+public:
+    NegativeCache();
+
+    void setTtl(qint64 seconds) { ttl = qMax<qint64>(0, seconds); }
+
+    // Counts a saved request when true
+    bool contains(const QString &key);
+    void insert(const QString &key);
+    void remove(const QString &key);
+    int size() const { return misses.size(); }
+
+    int savedRequests() const { return savedCount; }
+    // Share of words outside the table that the filter failed to reject
+    double falsePositiveRate() const;
+    QString statsSummary() const;
+
+    // Not owned; replays what the log holds beyond the loaded snapshot
+    void attachJournal(SharedJournal *log);
+
+    bool isModified() const { return modified; }
+    bool load(const QString &filePath);
+    // Keeps the latest miss per word, except for words removed here
+    bool merge(const QString &filePath);
+    // Merges with what other instances saved to the same file meanwhile
+    bool save(const QString &filePath);
+
+private:
+    void applyRecords(const QList<QByteArray> &records);
+    void insertAt(const QString &key, qint64 missedAt);
+    bool isExpired(qint64 missedAt) const;
+    void setBloomBits(const QString &key);
+    bool testBloomBits(const QString &key) const;
+    // Sizes the filter for the live entries and drops expired ones
+    void rebuild();
+
+    QHash<QString, qint64> misses;   // Key -> seconds since epoch of the miss
+    QSet<QString> removedKeys;       // Not to be merged back in from disk
+    QVector<quint64> bloomBits;
+    int hashCount;
+    qint64 ttl;
+
+    int savedCount;
+    int rejectedCount;
+    int falsePositiveCount;
+    SharedJournal *journal;
+    bool modified;
+};
+
+#endif // NEGATIVECACHE_H
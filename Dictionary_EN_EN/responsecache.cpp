@@ -0,0 +1,321 @@
+#include "responsecache.h"
+#include "sharedjournal.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QLockFile>
+#include <QSaveFile>
+
+namespace {
+const quint32 kCacheMagic = 0x52434143; // "RCAC"
+// Version 2 appends the alias table, version 3 each entry's backend
+const quint32 kCacheVersion = 3;
+
+// Journal records: a whole entry, a 304 moving its validation forward, or an alias
+enum RecordType : quint8 {
+    StoredRecord,
+    ValidatedRecord,
+    AliasRecord
+};
+
+QByteArray storedRecord(const QString &key, const CachedResponse &entry)
+{
+    QByteArray record;
+    QDataStream stream(&record, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << quint8(StoredRecord) << key << entry.queryWord << entry.data << entry.etag
+           << entry.lastModified << entry.fetchedAt << entry.validatedAt << entry.backend;
+    return record;
+}
+
+QByteArray validatedRecord(const QString &key, const CachedResponse &entry)
+{
+    QByteArray record;
+    QDataStream stream(&record, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << quint8(ValidatedRecord) << key << entry.etag << entry.lastModified << entry.validatedAt;
+    return record;
+}
+}
+
+ResponseCache::ResponseCache()
+    : journal(nullptr)
+    , freshTtl(7 * 24 * 3600)
+    , maxStale(365 * 24 * 3600)
+    , modified(false)
+{
+}
+
+void ResponseCache::setTtl(qint64 freshSeconds, qint64 maxStaleSeconds)
+{
+    freshTtl = qMax<qint64>(0, freshSeconds);
+    maxStale = qMax(freshTtl, maxStaleSeconds);
+}
+
+ResponseCache::Freshness ResponseCache::freshness(const QString &key) const
+{
+    auto it = entries.constFind(resolve(key));
+    if (it == entries.constEnd()) {
+        return Missing;
+    }
+
+    qint64 age = QDateTime::currentMSecsSinceEpoch() / 1000 - it->validatedAt;
+    if (age < freshTtl) {
+        return Fresh;
+    }
+    return age < maxStale ? Stale : Expired;
+}
+
+void ResponseCache::store(const QString &key, const CachedResponse &entry)
+{
+    CachedResponse stored = entry;
+    if (stored.fetchedAt == 0) {
+        stored.fetchedAt = QDateTime::currentMSecsSinceEpoch() / 1000;
+    }
+    if (stored.validatedAt == 0) {
+        stored.validatedAt = stored.fetchedAt;
+    }
+    entries.insert(key, stored);
+    modified = true;
+
+    if (journal) {
+        journal->append(storedRecord(key, stored));
+    }
+}
+
+void ResponseCache::markValidated(const QString &key, const QByteArray &etag, const QByteArray &lastModified)
+{
+    auto it = entries.find(resolve(key));
+    if (it == entries.end()) {
+        return;
+    }
+
+    it->validatedAt = QDateTime::currentMSecsSinceEpoch() / 1000;
+    if (!etag.isEmpty()) {
+        it->etag = etag;
+    }
+    if (!lastModified.isEmpty()) {
+        it->lastModified = lastModified;
+    }
+    modified = true;
+
+    if (journal) {
+        journal->append(validatedRecord(key, *it));
+    }
+}
+
+void ResponseCache::addAlias(const QString &key, const QString &target)
+{
+    if (key == target || aliases.value(key) == target) {
+        return;
+    }
+    aliases.insert(key, target);
+    modified = true;
+
+    if (journal) {
+        QByteArray record;
+        QDataStream stream(&record, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << quint8(AliasRecord) << key << target;
+        journal->append(record);
+    }
+}
+
+QString ResponseCache::resolve(const QString &key) const
+{
+    if (entries.contains(key)) {
+        return key;
+    }
+    return aliases.value(key, key);
+}
+
+void ResponseCache::attachJournal(SharedJournal *log)
+{
+    journal = log;
+
+    // Dropped with the journal, which emits nothing once the cache may be gone
+    QObject::connect(journal, &SharedJournal::recordsAdded, journal, [this](const QList<QByteArray> &records) {
+        applyRecords(records);
+    });
+    QObject::connect(journal, &SharedJournal::reset, journal, [this]() {
+        merge(journal->snapshotPath());
+    });
+    journal->readNew();
+}
+
+void ResponseCache::applyRecords(const QList<QByteArray> &records)
+{
+    // Our own records come back too; they match what we hold and change nothing
+    for (const QByteArray &record : records) {
+        QDataStream stream(record);
+        stream.setVersion(QDataStream::Qt_5_0);
+
+        quint8 type = 0;
+        QString key;
+        stream >> type >> key;
+        if (type == StoredRecord) {
+            CachedResponse entry;
+            stream >> entry.queryWord >> entry.data >> entry.etag >> entry.lastModified
+                   >> entry.fetchedAt >> entry.validatedAt >> entry.backend;
+            auto own = entries.constFind(key);
+            if (stream.status() == QDataStream::Ok
+                    && (own == entries.constEnd() || own->validatedAt < entry.validatedAt)) {
+                entries.insert(key, entry);
+            }
+        } else if (type == ValidatedRecord) {
+            QByteArray etag;
+            QByteArray lastModified;
+            qint64 validatedAt = 0;
+            stream >> etag >> lastModified >> validatedAt;
+            auto own = entries.find(key);
+            if (stream.status() == QDataStream::Ok
+                    && own != entries.end() && own->validatedAt < validatedAt) {
+                own->etag = etag;
+                own->lastModified = lastModified;
+                own->validatedAt = validatedAt;
+            }
+        } else if (type == AliasRecord) {
+            QString target;
+            stream >> target;
+            if (stream.status() == QDataStream::Ok) {
+                aliases.insert(key, target);
+            }
+        }
+    }
+}
+
+QStringList ResponseCache::staleKeys() const
+{
+    QStringList keys;
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        Freshness state = freshness(it.key());
+        if (state == Stale || state == Expired) {
+            keys.append(it.key());
+        }
+    }
+    return keys;
+}
+
+QHash<QString, QByteArray> ResponseCache::bodies() const
+{
+    QHash<QString, QByteArray> result;
+    result.reserve(entries.size());
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        result.insert(it.key(), it->data);
+    }
+    return result;
+}
+
+bool ResponseCache::load(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 count = 0;
+    stream >> magic >> version >> count;
+    if (magic != kCacheMagic || version < 1 || version > kCacheVersion || count < 0) {
+        return false;
+    }
+
+    QHash<QString, CachedResponse> loaded;
+    loaded.reserve(count);
+    for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString key;
+        CachedResponse entry;
+        stream >> key >> entry.queryWord >> entry.data >> entry.etag >> entry.lastModified
+               >> entry.fetchedAt >> entry.validatedAt;
+        if (version >= 3) {
+            stream >> entry.backend;
+        }
+        loaded.insert(key, entry);
+    }
+
+    QHash<QString, QString> loadedAliases;
+    if (version >= 2) {
+        qint32 aliasCount = 0;
+        stream >> aliasCount;
+        for (qint32 i = 0; i < aliasCount && stream.status() == QDataStream::Ok; ++i) {
+            QString key;
+            QString target;
+            stream >> key >> target;
+            loadedAliases.insert(key, target);
+        }
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    entries = loaded;
+    aliases = loadedAliases;
+    modified = false;
+    return true;
+}
+
+bool ResponseCache::merge(const QString &filePath)
+{
+    ResponseCache onDisk;
+    if (!onDisk.load(filePath)) {
+        return false;
+    }
+
+    for (auto it = onDisk.entries.constBegin(); it != onDisk.entries.constEnd(); ++it) {
+        auto own = entries.constFind(it.key());
+        if (own == entries.constEnd() || own->validatedAt < it->validatedAt) {
+            entries.insert(it.key(), it.value());
+        }
+    }
+    for (auto it = onDisk.aliases.constBegin(); it != onDisk.aliases.constEnd(); ++it) {
+        if (!aliases.contains(it.key())) {
+            aliases.insert(it.key(), it.value());
+        }
+    }
+    return true;
+}
+
+bool ResponseCache::save(const QString &filePath)
+{
+    // Other instances save the same file; merge under a lock so no one's entries are lost
+    QLockFile lock(filePath + ".lock");
+    if (!lock.tryLock(5000)) {
+        return false;
+    }
+
+    merge(filePath);
+    if (journal) {
+        // The snapshot replaces the log, so it must hold every record in it
+        journal->readNew();
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << kCacheMagic << kCacheVersion << qint32(entries.size());
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        stream << it.key() << it->queryWord << it->data << it->etag << it->lastModified
+               << it->fetchedAt << it->validatedAt << it->backend;
+    }
+    stream << qint32(aliases.size());
+    for (auto it = aliases.constBegin(); it != aliases.constEnd(); ++it) {
+        stream << it.key() << it.value();
+    }
+
+    if (!file.commit()) {
+        return false;
+    }
+    if (journal) {
+        journal->truncateLocked();
+    }
+    modified = false;
+    return true;
+}
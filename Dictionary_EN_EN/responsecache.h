@@ -0,0 +1,84 @@
+#ifndef RESPONSECACHE_H
+#define RESPONSECACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class SharedJournal;
+
+// One stored dictionary reply plus the HTTP validators needed to
+// revalidate it with a conditional GET
+struct CachedResponse
+{
+    QString queryWord;          // Word sent to the API, may differ from the cache key
+    QByteArray data;
+    QByteArray etag;
+    QByteArray lastModified;
+    qint64 fetchedAt = 0;       // Seconds since epoch the body was downloaded
+    qint64 validatedAt = 0;     // Last time the server confirmed the body
+    QString backend;            // Backend that answered; empty before version 3
+};
+
+// Lookup responses keyed by the normalized word sent to the API, persisted
+// between runs. A typed form the API only answered through its lemma is an
+// alias of the lemma's entry rather than a second copy. Entries are
+// fresh for freshTtl after their last validation, then stale: still
+// served, but due for background revalidation. Past maxStale they expire
+// and are treated as misses. With a journal attached, every change is
+// also logged there and changes logged by other instances are applied as
+// they arrive; save() folds the log into the snapshot file.
+class ResponseCache
+{
+public:
+    enum Freshness {
+        Missing,
+        Fresh,
+        Stale,
+        Expired
+    };
+
+    ResponseCache();
+
+    void setTtl(qint64 freshSeconds, qint64 maxStaleSeconds);
+
+    bool contains(const QString &key) const { return entries.contains(resolve(key)); }
+    CachedResponse value(const QString &key) const { return entries.value(resolve(key)); }
+    Freshness freshness(const QString &key) const;
+    int size() const { return entries.size(); }
+
+    void store(const QString &key, const CachedResponse &entry);
+    // A 304 only moves the validation time and picks up new validators
+    void markValidated(const QString &key, const QByteArray &etag, const QByteArray &lastModified);
+    // Answers key with the entry stored under target
+    void addAlias(const QString &key, const QString &target);
+
+    QStringList staleKeys() const;
+    QHash<QString, QByteArray> bodies() const;
+
+    // Not owned; replays what the log holds beyond the loaded snapshot
+    void attachJournal(SharedJournal *log);
+
+    bool isModified() const { return modified; }
+    bool load(const QString &filePath);
+    // Keeps whichever copy of an entry was validated last
+    bool merge(const QString &filePath);
+    // Merges with what other instances saved to the same file meanwhile
+    bool save(const QString &filePath);
+
+private:
+    // An entry's own key wins over an alias of the same name
+    QString resolve(const QString &key) const;
+    void applyRecords(const QList<QByteArray> &records);
+
+    QHash<QString, CachedResponse> entries;
+    QHash<QString, QString> aliases;    // Typed form -> key of the entry answering it
+    SharedJournal *journal;
+    qint64 freshTtl;
+    qint64 maxStale;
+    bool modified;
+};
+
+#endif // RESPONSECACHE_H
@@ -0,0 +1,223 @@
+#include "sharedjournal.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QLockFile>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <QtEndian>
+
+namespace {
+const quint32 kJournalMagic = 0x534a4e4c; // "SJNL"
+// Magic and generation, followed by records of a 32-bit length and payload
+const qint64 kHeaderSize = 12;
+const qint64 kLengthSize = 4;
+
+// Short enough not to stall the GUI thread
+const int kLockTimeoutMs = 20;
+const int kRetryIntervalMs = 250;
+// On exit queued records are worth a short wait
+const int kShutdownLockTimeoutMs = 2000;
+}
+
+SharedJournal::SharedJournal(const QString &snapshotPath, QObject *parent)
+    : QObject(parent)
+    , snapshot(snapshotPath)
+    , path(snapshotPath + ".log")
+    , lockFilePath(snapshotPath + ".lock")
+    , watcher(new QFileSystemWatcher(this))
+    , retryTimer(new QTimer(this))
+    , readOffset(kHeaderSize)
+    , generation(0)
+    , hasRead(false)
+{
+    retryTimer->setSingleShot(true);
+    retryTimer->setInterval(kRetryIntervalMs);
+    connect(retryTimer, &QTimer::timeout, this, [this]() {
+        flushQueue(kLockTimeoutMs);
+    });
+
+    watchFile();
+
+    connect(watcher, &QFileSystemWatcher::fileChanged, this, [this]() {
+        watchFile();
+        readNew();
+    });
+    connect(watcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+        watchFile();
+        readNew();
+    });
+}
+
+SharedJournal::~SharedJournal()
+{
+    // Whoever applied the records may already be gone
+    blockSignals(true);
+    if (!queue.isEmpty()) {
+        flushQueue(kShutdownLockTimeoutMs);
+    }
+}
+
+void SharedJournal::append(const QByteArray &record)
+{
+    queue.append(record);
+
+    // Already waiting on another instance; keeps the records in order
+    if (retryTimer->isActive()) {
+        return;
+    }
+    flushQueue(kLockTimeoutMs);
+}
+
+void SharedJournal::flushQueue(int lockTimeoutMs)
+{
+    QLockFile lock(lockFilePath);
+    if (!lock.tryLock(lockTimeoutMs)) {
+        retryTimer->start();
+        return;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        // The records are still in memory and go into the snapshot on exit
+        queue.clear();
+        return;
+    }
+    if (readGeneration(file) == 0) {
+        // First records since the log was created
+        file.resize(0);
+        writeHeader(file);
+    }
+
+    QByteArray data;
+    for (const QByteArray &record : queue) {
+        uchar length[kLengthSize];
+        qToBigEndian(quint32(record.size()), length);
+        data.append(reinterpret_cast<const char *>(length), kLengthSize);
+        data.append(record);
+    }
+    file.seek(file.size());
+    file.write(data);
+    file.close();
+    lock.unlock();
+    queue.clear();
+
+    // Picks up our own records along with anything other instances appended
+    watchFile();
+    readNew();
+}
+
+void SharedJournal::truncateLocked()
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return;
+    }
+    writeHeader(file);
+
+    // Whatever was still queued is part of the snapshot the caller wrote
+    queue.clear();
+    retryTimer->stop();
+}
+
+void SharedJournal::watchFile()
+{
+    // As in HistoryStore, the directory is watched only until the log exists
+    QString directory = QFileInfo(path).absolutePath();
+    if (!QFile::exists(path)) {
+        if (!watcher->directories().contains(directory)) {
+            watcher->addPath(directory);
+        }
+        return;
+    }
+
+    if (!watcher->files().contains(path)) {
+        watcher->addPath(path);
+    }
+    if (watcher->directories().contains(directory)) {
+        watcher->removePath(directory);
+    }
+}
+
+quint64 SharedJournal::readGeneration(QFile &file) const
+{
+    file.seek(0);
+    QByteArray header = file.read(kHeaderSize);
+    if (header.size() < kHeaderSize) {
+        return 0;
+    }
+
+    const uchar *data = reinterpret_cast<const uchar *>(header.constData());
+    if (qFromBigEndian<quint32>(data) != kJournalMagic) {
+        return 0;
+    }
+    return qFromBigEndian<quint64>(data + 4);
+}
+
+bool SharedJournal::writeHeader(QFile &file)
+{
+    // A new generation tells readers the old records are gone
+    generation = QRandomGenerator::global()->generate64() | 1;
+    readOffset = kHeaderSize;
+    hasRead = true;
+
+    uchar header[kHeaderSize];
+    qToBigEndian(kJournalMagic, header);
+    qToBigEndian(generation, header + 4);
+    return file.write(reinterpret_cast<const char *>(header), kHeaderSize) == kHeaderSize;
+}
+
+void SharedJournal::readNew()
+{
+    bool firstRead = !hasRead;
+    hasRead = true;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    quint64 current = readGeneration(file);
+    if (current == 0) {
+        return;
+    }
+    if (current != generation) {
+        generation = current;
+        readOffset = kHeaderSize;
+        if (!firstRead) {
+            emit reset();
+        }
+    }
+
+    qint64 size = file.size();
+    if (size <= readOffset) {
+        return;
+    }
+
+    // Plain reads rather than a mapping: the log may be truncated under us
+    file.seek(readOffset);
+    QByteArray data = file.read(size - readOffset);
+    if (readGeneration(file) != generation) {
+        // Compacted while reading; the bytes belong to the new generation
+        readNew();
+        return;
+    }
+
+    // Only whole records; one still being written is picked up next time
+    QList<QByteArray> records;
+    qint64 position = 0;
+    while (data.size() - position >= kLengthSize) {
+        const uchar *length = reinterpret_cast<const uchar *>(data.constData() + position);
+        qint64 recordSize = qFromBigEndian<quint32>(length);
+        if (data.size() - position - kLengthSize < recordSize) {
+            break;
+        }
+        records.append(data.mid(int(position + kLengthSize), int(recordSize)));
+        position += kLengthSize + recordSize;
+    }
+    readOffset += position;
+
+    if (!records.isEmpty()) {
+        emit recordsAdded(records);
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef SHAREDJOURNAL_H
+#define SHAREDJOURNAL_H
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+class QFile;
+class QFileSystemWatcher;
+class QTimer;
+
+// Append-only log of changes next to a snapshot file, shared by every
+// running instance. Appends hold the snapshot's lock file for a few
+// milliseconds at most; records that cannot be written right away are
+// queued and retried, so the GUI never waits on another process. Reads
+// seek past the last offset and parse only the new records, triggered by a
+// file watcher, so other instances' changes arrive without a reload. The
+// log is not mapped: compaction truncates it while others may be reading,
+// and touching a mapped page past the new end raises SIGBUS. When
+// an instance folds the log into the snapshot it starts a new generation,
+// which tells the others to merge the snapshot and read the log afresh.
+class SharedJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SharedJournal(const QString &snapshotPath, QObject *parent = nullptr);
+    ~SharedJournal();
+
+    QString snapshotPath() const { return snapshot; }
+    // Same lock file the snapshot's save() takes
+    QString lockPath() const { return lockFilePath; }
+
+    // Written now or, if the lock is held elsewhere, shortly after
+    void append(const QByteArray &record);
+    void readNew();
+    // Caller holds lockPath() and has just written a snapshot with everything read
+    void truncateLocked();
+
+signals:
+    // The log was folded into the snapshot by another instance
+    void reset();
+    void recordsAdded(const QList<QByteArray> &records);
+
+private:
+    void flushQueue(int lockTimeoutMs);
+    void watchFile();
+    // Zero if the file has no valid header yet
+    quint64 readGeneration(QFile &file) const;
+    bool writeHeader(QFile &file);
+
+    QString snapshot;
+    QString path;
+    QString lockFilePath;
+    QFileSystemWatcher *watcher;
+    QTimer *retryTimer;
+    QList<QByteArray> queue;
+    qint64 readOffset;
+    quint64 generation;
+    bool hasRead;
+};
+
+#endif // SHAREDJOURNAL_H
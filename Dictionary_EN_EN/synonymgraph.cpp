@@ -0,0 +1,310 @@
+#include "synonymgraph.h"
+#include <QDataStream>
+#include <QFile>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QSaveFile>
+#include <algorithm>
+
+namespace {
+const quint32 kGraphMagic = 0x53594e47; // "SYNG"
+const quint32 kGraphVersion = 1;
+
+inline quint64 edgeKey(quint32 a, quint32 b)
+{
+    return (quint64(qMin(a, b)) << 32) | qMax(a, b);
+}
+}
+
+SynonymGraph::SynonymGraph()
+    : currentStamp(0)
+    , modified(false)
+{
+}
+
+void SynonymGraph::addEntries(const QJsonArray &entries)
+{
+    for (const QPair<QString, QStringList> &list : synonymLists(entries)) {
+        addSynonyms(list.first, list.second);
+    }
+}
+
+QVector<QPair<QString, QStringList> > SynonymGraph::synonymLists(const QJsonArray &entries)
+{
+    QVector<QPair<QString, QStringList> > lists;
+    for (const QJsonValue &entryValue : entries) {
+        QJsonObject entry = entryValue.toObject();
+        QString word = entry["word"].toString();
+        if (word.isEmpty()) {
+            continue;
+        }
+
+        // Synonyms appear both per meaning and per definition
+        QStringList synonyms;
+        QJsonArray meanings = entry["meanings"].toArray();
+        for (const QJsonValue &meaningValue : meanings) {
+            QJsonObject meaning = meaningValue.toObject();
+            for (const QJsonValue &synonym : meaning["synonyms"].toArray()) {
+                synonyms.append(synonym.toString());
+            }
+            for (const QJsonValue &definitionValue : meaning["definitions"].toArray()) {
+                for (const QJsonValue &synonym : definitionValue.toObject()["synonyms"].toArray()) {
+                    synonyms.append(synonym.toString());
+                }
+            }
+        }
+        lists.append(qMakePair(word, synonyms));
+    }
+    return lists;
+}
+
+void SynonymGraph::addSynonyms(const QString &word, const QStringList &synonyms)
+{
+    if (synonyms.isEmpty()) {
+        return;
+    }
+
+    quint32 wordId = intern(word);
+    for (const QString &synonym : synonyms) {
+        QString key = synonym.trimmed().toLower();
+        if (key.isEmpty()) {
+            continue;
+        }
+        quint32 synonymId = intern(key);
+        // Entries are re-added on every display; only new edges cost anything
+        if (synonymId != wordId && !hasEdge(wordId, synonymId)) {
+            pendingEdges.append(qMakePair(wordId, synonymId));
+            pendingKeys.insert(edgeKey(wordId, synonymId));
+            modified = true;
+        }
+    }
+}
+
+int SynonymGraph::edgeCount() const
+{
+    compact();
+    return targets.size() / 2;
+}
+
+QStringList SynonymGraph::neighbours(const QString &word, int hops) const
+{
+    QStringList result;
+    auto it = wordIds.constFind(word.trimmed().toLower());
+    if (it == wordIds.constEnd()) {
+        return result;
+    }
+
+    compact();
+    visitStamp.resize(words.size());
+    if (++currentStamp == 0) {
+        visitStamp.fill(0);
+        currentStamp = 1;
+    }
+
+    // Breadth-first, one frontier per hop
+    QVector<quint32> frontier;
+    frontier.append(it.value());
+    visitStamp[it.value()] = currentStamp;
+
+    for (int hop = 0; hop < hops && !frontier.isEmpty(); ++hop) {
+        QVector<quint32> next;
+        for (quint32 node : frontier) {
+            for (quint32 i = offsets[node]; i < offsets[node + 1]; ++i) {
+                quint32 target = targets[i];
+                if (visitStamp[target] != currentStamp) {
+                    visitStamp[target] = currentStamp;
+                    next.append(target);
+                    result.append(words[target]);
+                }
+            }
+        }
+        frontier.swap(next);
+    }
+
+    return result;
+}
+
+QStringList SynonymGraph::related(const QString &word, int limit) const
+{
+    QStringList result;
+    auto it = wordIds.constFind(word.trimmed().toLower());
+    if (it == wordIds.constEnd()) {
+        return result;
+    }
+
+    compact();
+    visitStamp.resize(words.size());
+    if (++currentStamp == 0) {
+        visitStamp.fill(0);
+        currentStamp = 1;
+    }
+
+    // Direct synonyms are already on screen, so only rank the second hop
+    quint32 start = it.value();
+    visitStamp[start] = currentStamp;
+    for (quint32 i = offsets[start]; i < offsets[start + 1]; ++i) {
+        visitStamp[targets[i]] = currentStamp;
+    }
+
+    QHash<quint32, int> scores;
+    for (quint32 i = offsets[start]; i < offsets[start + 1]; ++i) {
+        quint32 neighbour = targets[i];
+        for (quint32 j = offsets[neighbour]; j < offsets[neighbour + 1]; ++j) {
+            if (visitStamp[targets[j]] != currentStamp) {
+                scores[targets[j]]++;
+            }
+        }
+    }
+
+    QVector<QPair<int, quint32> > ranked;
+    ranked.reserve(scores.size());
+    for (auto score = scores.constBegin(); score != scores.constEnd(); ++score) {
+        ranked.append(qMakePair(score.value(), score.key()));
+    }
+    std::sort(ranked.begin(), ranked.end(), [this](const QPair<int, quint32> &a, const QPair<int, quint32> &b) {
+        return a.first != b.first ? a.first > b.first : words[a.second] < words[b.second];
+    });
+
+    for (int i = 0; i < ranked.size() && i < limit; ++i) {
+        result.append(words[ranked[i].second]);
+    }
+    return result;
+}
+
+bool SynonymGraph::load(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QVector<QString> loadedWords;
+    QVector<quint32> loadedOffsets;
+    QVector<quint32> loadedTargets;
+    stream >> magic >> version >> loadedWords >> loadedOffsets >> loadedTargets;
+
+    if (stream.status() != QDataStream::Ok || magic != kGraphMagic || version != kGraphVersion
+            || loadedOffsets.size() != loadedWords.size() + 1
+            || loadedOffsets.last() != quint32(loadedTargets.size())) {
+        return false;
+    }
+
+    words = loadedWords;
+    offsets = loadedOffsets;
+    targets = loadedTargets;
+    pendingEdges.clear();
+    pendingKeys.clear();
+    wordIds.clear();
+    wordIds.reserve(words.size());
+    for (int i = 0; i < words.size(); ++i) {
+        wordIds.insert(words[i], quint32(i));
+    }
+    modified = false;
+    return true;
+}
+
+bool SynonymGraph::save(const QString &filePath)
+{
+    compact();
+
+    // Written to a temporary file and renamed, so a crash never leaves half a graph
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << kGraphMagic << kGraphVersion << words << offsets << targets;
+
+    if (!file.commit()) {
+        return false;
+    }
+    modified = false;
+    return true;
+}
+
+quint32 SynonymGraph::intern(const QString &word)
+{
+    QString key = word.trimmed().toLower();
+    auto it = wordIds.constFind(key);
+    if (it != wordIds.constEnd()) {
+        return it.value();
+    }
+
+    quint32 id = quint32(words.size());
+    wordIds.insert(key, id);
+    words.append(key);
+    return id;
+}
+
+bool SynonymGraph::hasEdge(quint32 from, quint32 to) const
+{
+    if (pendingKeys.contains(edgeKey(from, to))) {
+        return true;
+    }
+    if (int(from) + 1 >= offsets.size()) {
+        return false;
+    }
+
+    // Rows are sorted, and the graph is symmetric, so one row is enough
+    const quint32 *row = targets.constData();
+    return std::binary_search(row + offsets[from], row + offsets[from + 1], to);
+}
+
+void SynonymGraph::compact() const
+{
+    int nodeCount = words.size();
+    if (pendingEdges.isEmpty()) {
+        // Words interned without edges only extend the offsets
+        if (offsets.isEmpty()) {
+            offsets.append(0);
+        }
+        while (offsets.size() < nodeCount + 1) {
+            offsets.append(offsets.last());
+        }
+        return;
+    }
+
+    // Only the new edges are sorted; the existing rows already are, so
+    // both are merged row by row in a single pass
+    QVector<QPair<quint32, quint32> > added;
+    added.reserve(pendingEdges.size() * 2);
+    for (const QPair<quint32, quint32> &edge : pendingEdges) {
+        added.append(edge);
+        added.append(qMakePair(edge.second, edge.first));
+    }
+    pendingEdges.clear();
+    pendingKeys.clear();
+    std::sort(added.begin(), added.end());
+
+    int oldRows = qMax(0, offsets.size() - 1);
+    QVector<quint32> mergedOffsets(nodeCount + 1, 0);
+    QVector<quint32> mergedTargets;
+    mergedTargets.reserve(targets.size() + added.size());
+
+    int next = 0;
+    for (int node = 0; node < nodeCount; ++node) {
+        mergedOffsets[node] = quint32(mergedTargets.size());
+        quint32 i = node < oldRows ? offsets[node] : 0;
+        quint32 end = node < oldRows ? offsets[node + 1] : 0;
+        while (i < end || (next < added.size() && added[next].first == quint32(node))) {
+            bool takeAdded = next < added.size() && added[next].first == quint32(node)
+                    && (i >= end || added[next].second < targets[i]);
+            if (takeAdded) {
+                mergedTargets.append(added[next++].second);
+            } else {
+                mergedTargets.append(targets[i++]);
+            }
+        }
+    }
+    mergedOffsets[nodeCount] = quint32(mergedTargets.size());
+
+    offsets.swap(mergedOffsets);
+    targets.swap(mergedTargets);
+}
@@ -0,0 +1,62 @@
+#ifndef SYNONYMGRAPH_H
+#define SYNONYMGRAPH_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Undirected synonym graph built from every entry the app has seen.
+// Words are interned to dense ids and adjacency is kept in CSR form
+// (offsets + targets), so neighbour and k-hop queries touch only a few
+// contiguous arrays and answer in microseconds. Edges already in the graph
+// are ignored; new ones are buffered and merged into the sorted CSR rows
+// on the next query, without re-sorting the existing edges.
+class SynonymGraph
+{
+public:
+    SynonymGraph();
+
+    // Entry array in the dictionaryapi.dev JSON format
+    void addEntries(const QJsonArray &entries);
+    void addSynonyms(const QString &word, const QStringList &synonyms);
+
+    // (word, synonyms) pairs of an entry array; pure, so it can run on a worker
+    static QVector<QPair<QString, QStringList> > synonymLists(const QJsonArray &entries);
+
+    int wordCount() const { return words.size(); }
+    int edgeCount() const;
+    bool isModified() const { return modified; }
+
+    // Words reachable within the given number of hops, nearest first
+    QStringList neighbours(const QString &word, int hops = 1) const;
+    // Two-hop words ranked by how many synonyms they share with word
+    QStringList related(const QString &word, int limit = 8) const;
+
+    bool load(const QString &filePath);
+    bool save(const QString &filePath);
+
+private:
+    quint32 intern(const QString &word);
+    bool hasEdge(quint32 from, quint32 to) const;
+    void compact() const;
+
+    QHash<QString, quint32> wordIds;
+    QVector<QString> words;
+
+    mutable QVector<quint32> offsets;
+    mutable QVector<quint32> targets;
+    mutable QVector<QPair<quint32, quint32> > pendingEdges;
+    mutable QSet<quint64> pendingKeys;     // Undirected keys of pendingEdges
+
+    // Visit marks for traversals; bumping the stamp avoids clearing the array
+    mutable QVector<quint32> visitStamp;
+    mutable quint32 currentStamp;
+
+    bool modified;
+};
+
+#endif // SYNONYMGRAPH_H
@@ -0,0 +1,376 @@
+#include "textkernels.h"
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QtAlgorithms>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXTKERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(TEXTKERNELS_SSE2) && (defined(__GNUC__) || defined(_MSC_VER))
+#define TEXTKERNELS_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TEXTKERNELS_TARGET_AVX2
+#else
+#define TEXTKERNELS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+// Up to five code units to search for; unused slots repeat the first one
+struct Needles
+{
+    explicit Needles(const char *set)
+    {
+        int count = 0;
+        while (set[count] && count < 5) {
+            chars[count] = ushort(set[count]);
+            count++;
+        }
+        for (int i = count; i < 5; ++i) {
+            chars[i] = chars[0];
+        }
+    }
+
+    ushort chars[5];
+};
+
+int findNextScalar(const ushort *data, int from, int to, const Needles &needles)
+{
+    for (int i = from; i < to; ++i) {
+        ushort c = data[i];
+        if (c == needles.chars[0] || c == needles.chars[1] || c == needles.chars[2]
+                || c == needles.chars[3] || c == needles.chars[4]) {
+            return i;
+        }
+    }
+    return to;
+}
+
+#ifdef TEXTKERNELS_SSE2
+int findNextSse2(const ushort *data, int from, int to, const Needles &needles)
+{
+    const __m128i n0 = _mm_set1_epi16(short(needles.chars[0]));
+    const __m128i n1 = _mm_set1_epi16(short(needles.chars[1]));
+    const __m128i n2 = _mm_set1_epi16(short(needles.chars[2]));
+    const __m128i n3 = _mm_set1_epi16(short(needles.chars[3]));
+    const __m128i n4 = _mm_set1_epi16(short(needles.chars[4]));
+
+    int i = from;
+    for (; i + 8 <= to; i += 8) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(chunk, n0), _mm_cmpeq_epi16(chunk, n1)),
+                                    _mm_or_si128(_mm_cmpeq_epi16(chunk, n2), _mm_cmpeq_epi16(chunk, n3)));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi16(chunk, n4));
+        int mask = _mm_movemask_epi8(hits);
+        if (mask) {
+            // Two mask bits per UTF-16 code unit
+            return i + int(qCountTrailingZeroBits(quint32(mask)) / 2);
+        }
+    }
+    return findNextScalar(data, i, to, needles);
+}
+#endif
+
+#ifdef TEXTKERNELS_AVX2
+TEXTKERNELS_TARGET_AVX2
+int findNextAvx2(const ushort *data, int from, int to, const Needles &needles)
+{
+    const __m256i n0 = _mm256_set1_epi16(short(needles.chars[0]));
+    const __m256i n1 = _mm256_set1_epi16(short(needles.chars[1]));
+    const __m256i n2 = _mm256_set1_epi16(short(needles.chars[2]));
+    const __m256i n3 = _mm256_set1_epi16(short(needles.chars[3]));
+    const __m256i n4 = _mm256_set1_epi16(short(needles.chars[4]));
+
+    int i = from;
+    for (; i + 16 <= to; i += 16) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi16(chunk, n0), _mm256_cmpeq_epi16(chunk, n1)),
+                                       _mm256_or_si256(_mm256_cmpeq_epi16(chunk, n2), _mm256_cmpeq_epi16(chunk, n3)));
+        hits = _mm256_or_si256(hits, _mm256_cmpeq_epi16(chunk, n4));
+        quint32 mask = quint32(_mm256_movemask_epi8(hits));
+        if (mask) {
+            return i + int(qCountTrailingZeroBits(mask) / 2);
+        }
+    }
+    return findNextSse2(data, i, to, needles);
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    // AVX2 also needs the OS to save the YMM registers
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+typedef int (*FindNextFunction)(const ushort *, int, int, const Needles &);
+
+struct KernelSelection
+{
+    FindNextFunction findNext;
+    const char *name;
+};
+
+KernelSelection selectKernel()
+{
+#ifdef TEXTKERNELS_AVX2
+    if (cpuHasAvx2()) {
+        return { findNextAvx2, "AVX2" };
+    }
+#endif
+#ifdef TEXTKERNELS_SSE2
+    return { findNextSse2, "SSE2" };
+#else
+    return { findNextScalar, "scalar" };
+#endif
+}
+
+const KernelSelection kernel = selectKernel();
+
+const Needles escapeNeedles("&<>\"'");
+const Needles tagOpenNeedles("<");
+const Needles tagCloseNeedles(">");
+const Needles entityNeedles("&");
+
+inline const ushort *codeUnits(const QString &text)
+{
+    return reinterpret_cast<const ushort *>(text.constData());
+}
+
+bool matchesAt(const QString &text, int pos, QLatin1String name)
+{
+    if (pos + name.size() > text.size()) {
+        return false;
+    }
+    for (int i = 0; i < name.size(); ++i) {
+        if (text.at(pos + i) != QLatin1Char(name.data()[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Decodes the entity starting at text[start] ('&') into one or two UTF-16
+// units (decoded[0..*units)); returns the entity's length or 0
+int decodeEntityAt(const QString &text, int start, QChar decoded[2], int *units)
+{
+    static const struct {
+        const char *name;
+        ushort value;
+    } namedEntities[] = {
+        { "amp;", '&' }, { "lt;", '<' }, { "gt;", '>' }, { "quot;", '"' },
+        { "apos;", '\'' }, { "#39;", '\'' }, { "nbsp;", ' ' }
+    };
+
+    for (const auto &entity : namedEntities) {
+        QLatin1String name(entity.name);
+        if (matchesAt(text, start + 1, name)) {
+            decoded[0] = QChar(entity.value);
+            *units = 1;
+            return name.size() + 1;
+        }
+    }
+
+    // Numeric references: &#123; and &#x7B;
+    if (start + 2 < text.size() && text.at(start + 1) == QLatin1Char('#')) {
+        int end = text.indexOf(QLatin1Char(';'), start + 2);
+        if (end > start + 2 && end - start <= 10) {
+            bool ok = false;
+            uint value = 0;
+            if (text.at(start + 2) == QLatin1Char('x') || text.at(start + 2) == QLatin1Char('X')) {
+                value = text.mid(start + 3, end - start - 3).toUInt(&ok, 16);
+            } else {
+                value = text.mid(start + 2, end - start - 2).toUInt(&ok, 10);
+            }
+            // Lone surrogates and values past U+10FFFF are not characters
+            bool valid = ok && value > 0 && value <= 0x10FFFF && (value < 0xD800 || value > 0xDFFF);
+            if (valid && QChar::requiresSurrogates(value)) {
+                decoded[0] = QChar(QChar::highSurrogate(value));
+                decoded[1] = QChar(QChar::lowSurrogate(value));
+                *units = 2;
+                return end - start + 1;
+            }
+            if (valid) {
+                decoded[0] = QChar(ushort(value));
+                *units = 1;
+                return end - start + 1;
+            }
+        }
+    }
+    return 0;
+}
+
+}
+
+QString TextKernels::escapeHtml(const QString &text)
+{
+    const ushort *data = codeUnits(text);
+    const int length = text.size();
+
+    int next = kernel.findNext(data, 0, length, escapeNeedles);
+    if (next == length) {
+        return text;
+    }
+
+    QString escaped;
+    escaped.reserve(length + length / 8 + 16);
+    int start = 0;
+    while (next < length) {
+        escaped.append(text.constData() + start, next - start);
+        switch (data[next]) {
+        case '&': escaped.append(QLatin1String("&amp;")); break;
+        case '<': escaped.append(QLatin1String("&lt;")); break;
+        case '>': escaped.append(QLatin1String("&gt;")); break;
+        case '"': escaped.append(QLatin1String("&quot;")); break;
+        default: escaped.append(QLatin1String("&#39;")); break;
+        }
+        start = next + 1;
+        next = kernel.findNext(data, start, length, escapeNeedles);
+    }
+    escaped.append(text.constData() + start, length - start);
+    return escaped;
+}
+
+QString TextKernels::stripTags(const QString &html)
+{
+    const ushort *data = codeUnits(html);
+    const int length = html.size();
+
+    int open = kernel.findNext(data, 0, length, tagOpenNeedles);
+    if (open == length) {
+        return html;
+    }
+
+    QString text;
+    text.reserve(length);
+    int start = 0;
+    while (open < length) {
+        int close = kernel.findNext(data, open + 1, length, tagCloseNeedles);
+        if (close == length) {
+            // An unterminated '<' is text, as with the regex
+            break;
+        }
+        text.append(html.constData() + start, open - start);
+        start = close + 1;
+        open = kernel.findNext(data, start, length, tagOpenNeedles);
+    }
+    text.append(html.constData() + start, length - start);
+    return text;
+}
+
+QString TextKernels::decodeEntities(const QString &text)
+{
+    const ushort *data = codeUnits(text);
+    const int length = text.size();
+
+    int amp = kernel.findNext(data, 0, length, entityNeedles);
+    if (amp == length) {
+        return text;
+    }
+
+    QString decoded;
+    decoded.reserve(length);
+    int start = 0;
+    while (amp < length) {
+        QChar value[2];
+        int units = 0;
+        int entityLength = decodeEntityAt(text, amp, value, &units);
+        if (entityLength > 0) {
+            decoded.append(text.constData() + start, amp - start);
+            decoded.append(value, units);
+            start = amp + entityLength;
+        }
+        amp = kernel.findNext(data, amp + qMax(1, entityLength), length, entityNeedles);
+    }
+    decoded.append(text.constData() + start, length - start);
+    return decoded;
+}
+
+const char *TextKernels::activeKernel()
+{
+    return kernel.name;
+}
+
+QString TextKernels::benchmark(int iterations)
+{
+    // A history-sized entry as produced by EntryFormatter::html()
+    QString sample;
+    for (int i = 1; i <= 5; ++i) {
+        sample += QString("<h3 style='color: #A23B72; background-color: #f0f0f0; padding: 5px;'>[NOUN]</h3>"
+                          "<p><b>%1.</b> A definition with an example &amp; some &lt;markup&gt; in it"
+                          "<br><i>Example: the quick brown fox jumps over the lazy dog</i>"
+                          "<br><span style='color: #666;'><b>Synonyms:</b> <a href='word:alpha'>alpha</a>, "
+                          "<a href='word:beta'>beta</a></span></p>").arg(i);
+    }
+    QString plain = QString("A plain definition without any markup at all, as most API strings are. ").repeated(8);
+
+    QStringList lines;
+    lines << QString("Text kernels: %1, %2 iterations, %3 UTF-16 units per sample")
+             .arg(activeKernel()).arg(iterations).arg(sample.size());
+
+    auto run = [iterations](const char *label, const QString &input, QString (*function)(const QString &)) {
+        QElapsedTimer timer;
+        timer.start();
+        int checksum = 0;
+        for (int i = 0; i < iterations; ++i) {
+            checksum += function(input).size();
+        }
+        qint64 ns = timer.nsecsElapsed() / iterations;
+        return qMakePair(QString("%1: %2 ns/call").arg(label).arg(ns), checksum);
+    };
+
+    QString (*regexStrip)(const QString &) = [](const QString &html) {
+        QString text = html;
+        text.remove(QRegularExpression("<[^>]*>"));
+        text.replace("&nbsp;", " ");
+        return text;
+    };
+    QString (*kernelStrip)(const QString &) = [](const QString &html) {
+        return TextKernels::decodeEntities(TextKernels::stripTags(html));
+    };
+    QString (*replaceEscape)(const QString &) = [](const QString &text) {
+        QString escaped = text;
+        escaped.replace("&", "&amp;");
+        escaped.replace("<", "&lt;");
+        escaped.replace(">", "&gt;");
+        escaped.replace("\"", "&quot;");
+        escaped.replace("'", "&#39;");
+        return escaped;
+    };
+
+    lines << run("regex strip (saveWordToHistory before)", sample, regexStrip).first;
+    lines << run("kernel strip + decode", sample, kernelStrip).first;
+    lines << run("replace() escape, plain text", plain, replaceEscape).first;
+    lines << run("kernel escape, plain text", plain, TextKernels::escapeHtml).first;
+    lines << run("replace() escape, markup", sample, replaceEscape).first;
+    lines << run("kernel escape, markup", sample, TextKernels::escapeHtml).first;
+
+    bool stripMatches = stripTags(sample) == QString(sample).remove(QRegularExpression("<[^>]*>"));
+    bool escapeMatches = escapeHtml(sample) == replaceEscape(sample);
+    lines << QString("Outputs match reference: strip %1, escape %2")
+             .arg(stripMatches ? "yes" : "NO", escapeMatches ? "yes" : "NO");
+
+    return lines.join("\n");
+}